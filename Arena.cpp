@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include "Arena.h"
+
+/**
+ * Default constructor that creates an empty Arena.
+ */
+Arena::Arena() : nextBlockSize(kMinBlockSize) {}
+
+/**
+ * Destructor that frees every block at once.
+ */
+Arena::~Arena() {
+    release();
+}
+
+/**
+ * Move constructor. Takes over the blocks of another Arena.
+ * @param other The Arena to take the blocks from.
+ */
+Arena::Arena(Arena&& other) noexcept
+        : blocks(std::move(other.blocks)), cursor(other.cursor), limit(other.limit),
+          nextBlockSize(other.nextBlockSize), used(other.used) {
+    other.blocks.clear();
+    other.cursor = nullptr;
+    other.limit = nullptr;
+    other.nextBlockSize = kMinBlockSize;
+    other.used = 0;
+}
+
+/**
+ * Move assignment operator. Frees the current blocks and takes over the blocks of another Arena.
+ * @param other The Arena to take the blocks from.
+ * @return A reference to the updated Arena.
+ */
+Arena& Arena::operator=(Arena&& other) noexcept {
+    if (this != &other) {
+        release();
+        blocks = std::move(other.blocks);
+        cursor = other.cursor;
+        limit = other.limit;
+        nextBlockSize = other.nextBlockSize;
+        used = other.used;
+        other.blocks.clear();
+        other.cursor = nullptr;
+        other.limit = nullptr;
+        other.nextBlockSize = kMinBlockSize;
+        other.used = 0;
+    }
+    return *this;
+}
+
+/**
+ * Allocate memory from the current block, starting a new block when it is exhausted.
+ * @param bytes The number of bytes to allocate.
+ * @param alignment The required alignment (a power of two).
+ * @return A pointer to the allocated memory.
+ */
+void* Arena::allocate(size_t bytes, size_t alignment) {
+    uintptr_t address = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (cursor == nullptr || address + bytes > reinterpret_cast<uintptr_t>(limit)) {
+        addBlock(bytes + alignment);
+        address = (reinterpret_cast<uintptr_t>(cursor) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+    cursor = reinterpret_cast<char*>(address + bytes);
+    used += bytes;
+    return reinterpret_cast<void*>(address);
+}
+
+/**
+ * Copy a string into the arena and null-terminate it.
+ * @param str The characters to copy.
+ * @return A pointer to the null-terminated copy.
+ */
+char* Arena::copyString(std::string_view str) {
+    char* copy = static_cast<char*>(allocate(str.size() + 1, 1));
+    std::memcpy(copy, str.data(), str.size());
+    copy[str.size()] = '\0';
+    return copy;
+}
+
+/**
+ * Take ownership of every block of another Arena, leaving it empty.
+ * This arena keeps allocating from its own current block.
+ * @param other The Arena whose blocks are taken over.
+ */
+void Arena::adopt(Arena& other) {
+    if (this == &other) {
+        return;
+    }
+    blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+    used += other.used;
+    other.blocks.clear();
+    other.cursor = nullptr;
+    other.limit = nullptr;
+    other.nextBlockSize = kMinBlockSize;
+    other.used = 0;
+}
+
+/**
+ * Returns the number of bytes handed out so far.
+ * @return The number of bytes allocated from the arena.
+ */
+size_t Arena::bytesUsed() const {
+    return used;
+}
+
+/**
+ * Returns the number of bytes reserved from the heap.
+ * @return The total size of all blocks.
+ */
+size_t Arena::bytesReserved() const {
+    size_t total = 0;
+    for (const Block& block : blocks) {
+        total += block.size;
+    }
+    return total;
+}
+
+/**
+ * Allocate a fresh block that can hold at least the given number of bytes.
+ * Block sizes double from kMinBlockSize up to kMaxBlockSize.
+ * @param bytes The number of bytes the caller needs.
+ */
+void Arena::addBlock(size_t bytes) {
+    size_t size = std::max(nextBlockSize, bytes);
+    nextBlockSize = std::min(nextBlockSize * 2, kMaxBlockSize);
+    char* data = new char[size];
+    blocks.push_back(Block{ data, size });
+    cursor = data;
+    limit = data + size;
+}
+
+/**
+ * Free every block.
+ */
+void Arena::release() {
+    for (const Block& block : blocks) {
+        delete[] block.data;
+    }
+    blocks.clear();
+    cursor = nullptr;
+    limit = nullptr;
+    used = 0;
+}
@@ -0,0 +1,117 @@
+#ifndef ARENA_H_
+#define ARENA_H_
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+/**
+ * The Arena class is a bump allocator: memory is handed out from large blocks and is only released,
+ * all at once, when the Arena is destroyed. Objects placed in an Arena are never freed individually.
+ * An Arena is not thread-safe; every thread that builds data needs its own.
+ */
+class Arena {
+private:
+    /**
+     * A block of memory obtained from the heap.
+     */
+    struct Block {
+        char* data;
+        size_t size;
+    };
+
+    /** Every block owned by the arena */
+    std::vector<Block> blocks;
+
+    /** Next free byte in the current block */
+    char* cursor{ nullptr };
+
+    /** End of the current block */
+    char* limit{ nullptr };
+
+    /** Size of the next block to allocate; doubles up to kMaxBlockSize */
+    size_t nextBlockSize;
+
+    /** Total number of bytes handed out */
+    size_t used{ 0 };
+
+    /** Size of the first block */
+    static constexpr size_t kMinBlockSize = 64 * 1024;
+
+    /** Largest block size the arena grows to (bigger requests get a block of their own) */
+    static constexpr size_t kMaxBlockSize = 4 * 1024 * 1024;
+
+    /**
+     * Allocate a fresh block that can hold at least the given number of bytes.
+     * @param bytes The number of bytes the caller needs.
+     */
+    void addBlock(size_t bytes);
+
+    /**
+     * Free every block.
+     */
+    void release();
+
+public:
+    /**
+     * Default constructor that creates an empty Arena. No memory is allocated until the first request.
+     */
+    Arena();
+
+    /**
+     * Destructor that frees every block at once.
+     */
+    ~Arena();
+
+    // The memory of an arena has a single owner.
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /**
+     * Move constructor. Takes over the blocks of another Arena.
+     * @param other The Arena to take the blocks from.
+     */
+    Arena(Arena&& other) noexcept;
+
+    /**
+     * Move assignment operator. Frees the current blocks and takes over the blocks of another Arena.
+     * @param other The Arena to take the blocks from.
+     * @return A reference to the updated Arena.
+     */
+    Arena& operator=(Arena&& other) noexcept;
+
+    /**
+     * Allocate memory from the arena.
+     * @param bytes The number of bytes to allocate.
+     * @param alignment The required alignment (a power of two).
+     * @return A pointer to the allocated memory.
+     */
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+    /**
+     * Copy a string into the arena and null-terminate it.
+     * @param str The characters to copy.
+     * @return A pointer to the null-terminated copy.
+     */
+    char* copyString(std::string_view str);
+
+    /**
+     * Take ownership of every block of another Arena, leaving it empty.
+     * Memory handed out by the other Arena stays valid for as long as this Arena lives.
+     * @param other The Arena whose blocks are taken over.
+     */
+    void adopt(Arena& other);
+
+    /**
+     * Returns the number of bytes handed out so far.
+     * @return The number of bytes allocated from the arena.
+     */
+    size_t bytesUsed() const;
+
+    /**
+     * Returns the number of bytes reserved from the heap.
+     * @return The total size of all blocks.
+     */
+    size_t bytesReserved() const;
+};
+
+#endif /* ARENA_H_ */
@@ -0,0 +1,516 @@
+/**
+ * @file Benchmark.cpp
+ * @brief Measures the stages of the indexing pipeline on a synthetic corpus.
+ *
+ * The corpus is generated from a fixed seed: a vocabulary of random words whose occurrences follow a Zipfian
+ * distribution, written a fixed number of words per line. Each stage is run several times and the fastest run
+ * is reported, together with its throughput and the peak resident memory of the process during the stage.
+ *
+ * Usage: benchmark [--tokens N] [--vocab N] [--zipf S] [--words-per-line N] [--threads N] [--repeat N]
+ *                  [--seed N] [--corpus PATH] [--keep] [--csv]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Dictionary.h"
+#include "NumList.h"
+#include "WordList.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+using std::cout;
+using std::string;
+
+/**
+ * Settings of a benchmark run, filled in from the command line.
+ */
+struct BenchmarkOptions {
+    /** Number of words in the corpus */
+    size_t tokens = 2000000;
+
+    /** Number of distinct words the corpus is drawn from */
+    size_t vocabulary = 50000;
+
+    /** Exponent of the Zipfian distribution (1.0 is classic Zipf) */
+    double zipf = 1.0;
+
+    /** Number of words on each line of the corpus */
+    size_t wordsPerLine = 12;
+
+    /** Threads for IngestMode::Parallel, or 0 for one per hardware thread */
+    unsigned threads = 0;
+
+    /** Number of runs per stage; the fastest is reported */
+    int repeat = 3;
+
+    /** Seed of the corpus generator */
+    unsigned long long seed = 42;
+
+    /** Where the corpus file is written (default is the temporary directory) */
+    string corpusPath;
+
+    /** Keep the corpus file after the run */
+    bool keep = false;
+
+    /** Print results as comma-separated values */
+    bool csv = false;
+};
+
+/**
+ * The synthetic corpus: its vocabulary and the sequence of word ranks it is made of.
+ */
+struct Corpus {
+    std::vector<string> vocabulary;
+    std::vector<unsigned> ranks;
+    size_t bytes = 0;
+};
+
+/**
+ * The measurements of one stage.
+ */
+struct StageResult {
+    string name;
+    double seconds;
+    double items;
+    const char* unit;
+    double megabytes;
+    long peakKb;
+};
+
+/**
+ * Stream buffer that discards everything written to it, so printing is measured without disk I/O.
+ */
+class NullBuffer : public std::streambuf {
+protected:
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+    int overflow(int c) override { return traits_type::not_eof(c); }
+};
+
+/**
+ * @brief Resets the peak resident set size of the process, where the platform supports it (Linux)
+ */
+static void resetPeakMemory() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (clearRefs) {
+        clearRefs << "5";
+    }
+}
+
+/**
+ * @brief Returns the peak resident set size of the process
+ *
+ * @return long The peak in kilobytes, or 0 if it is not available
+ */
+static long peakMemoryKb() {
+    std::ifstream status("/proc/self/status");
+    string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtol(line.c_str() + 6, nullptr, 10);
+        }
+    }
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__)
+        return usage.ru_maxrss / 1024; // bytes on macOS
+#else
+        return usage.ru_maxrss;
+#endif
+    }
+#endif
+    return 0;
+}
+
+/**
+ * @brief Generates the vocabulary and the Zipfian sequence of ranks
+ *
+ * @param options The benchmark settings
+ * @return Corpus The generated corpus
+ */
+static Corpus generateCorpus(const BenchmarkOptions& options) {
+    Corpus corpus;
+    std::mt19937_64 random(options.seed);
+
+    // Mostly lowercase words, some capitalised, a few starting with a digit or punctuation
+    static const char letters[] = "abcdefghijklmnopqrstuvwxyz";
+    static const char others[] = "0123456789'\"(-";
+    std::uniform_int_distribution<int> length(2, 12);
+    std::uniform_int_distribution<int> letter(0, 25);
+    std::uniform_int_distribution<int> other(0, sizeof(others) - 2);
+    std::uniform_int_distribution<int> percent(0, 99);
+    corpus.vocabulary.reserve(options.vocabulary);
+    while (corpus.vocabulary.size() < options.vocabulary) {
+        string word(length(random), ' ');
+        for (char& c : word) {
+            c = letters[letter(random)];
+        }
+        int kind = percent(random);
+        if (kind < 10) {
+            word[0] = static_cast<char>(word[0] - 'a' + 'A');
+        } else if (kind < 13) {
+            word[0] = others[other(random)];
+        }
+        corpus.vocabulary.push_back(std::move(word));
+    }
+    std::sort(corpus.vocabulary.begin(), corpus.vocabulary.end());
+    corpus.vocabulary.erase(std::unique(corpus.vocabulary.begin(), corpus.vocabulary.end()), corpus.vocabulary.end());
+    std::shuffle(corpus.vocabulary.begin(), corpus.vocabulary.end(), random); // Rank must not follow sort order
+
+    // Cumulative Zipf weights, sampled by binary search
+    std::vector<double> cumulative(corpus.vocabulary.size());
+    double total = 0;
+    for (size_t rank = 0; rank < cumulative.size(); ++rank) {
+        total += 1.0 / std::pow(static_cast<double>(rank + 1), options.zipf);
+        cumulative[rank] = total;
+    }
+    std::uniform_real_distribution<double> uniform(0.0, total);
+    corpus.ranks.resize(options.tokens);
+    for (unsigned& rank : corpus.ranks) {
+        rank = static_cast<unsigned>(std::lower_bound(cumulative.begin(), cumulative.end(), uniform(random)) - cumulative.begin());
+        if (rank >= cumulative.size()) {
+            rank = static_cast<unsigned>(cumulative.size() - 1);
+        }
+        corpus.bytes += corpus.vocabulary[rank].size() + 1;
+    }
+    return corpus;
+}
+
+/**
+ * @brief Writes the corpus as text, a fixed number of words per line
+ *
+ * @param corpus The corpus to write
+ * @param options The benchmark settings
+ * @param path The name of the file to write
+ */
+static void writeCorpus(const Corpus& corpus, const BenchmarkOptions& options, const string& path) {
+    std::ofstream fout(path, std::ios::binary | std::ios::trunc);
+    if (!fout) {
+        std::cerr << "could not create corpus file: " << path << "\n";
+        exit(1);
+    }
+    string line;
+    for (size_t i = 0; i < corpus.ranks.size(); ++i) {
+        line += corpus.vocabulary[corpus.ranks[i]];
+        bool lineEnd = (i + 1) % options.wordsPerLine == 0 || i + 1 == corpus.ranks.size();
+        line += lineEnd ? '\n' : ' ';
+        if (lineEnd) {
+            fout << line;
+            line.clear();
+        }
+    }
+}
+
+/**
+ * @brief Runs one stage repeatedly and records its fastest run
+ *
+ * @param name The name of the stage
+ * @param items The number of items one run processes
+ * @param unit What an item is
+ * @param megabytes The number of megabytes one run processes, or 0 if not meaningful
+ * @param repeat The number of runs
+ * @param run The stage; anything it builds must be released before it returns
+ * @return StageResult The measurements of the stage
+ */
+static StageResult measure(const string& name, double items, const char* unit, double megabytes, int repeat,
+                           const std::function<void()>& run) {
+    StageResult result{ name, 0.0, items, unit, megabytes, 0 };
+    resetPeakMemory();
+    for (int i = 0; i < repeat; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (i == 0 || seconds < result.seconds) {
+            result.seconds = seconds;
+        }
+    }
+    result.peakKb = peakMemoryKb();
+    return result;
+}
+
+/**
+ * @brief Prints the result of a stage
+ *
+ * @param result The measurements of the stage
+ * @param csv Whether to print comma-separated values
+ */
+static void report(const StageResult& result, bool csv) {
+    double perSecond = result.seconds > 0 ? result.items / result.seconds : 0;
+    double megabytesPerSecond = result.seconds > 0 ? result.megabytes / result.seconds : 0;
+    char line[256];
+    if (csv) {
+        std::snprintf(line, sizeof(line), "%s,%.6f,%.0f,%s,%.2f,%ld\n", result.name.c_str(), result.seconds,
+                      perSecond, result.unit, megabytesPerSecond, result.peakKb);
+    } else {
+        string rate = string(result.unit) + "/s";
+        char bandwidth[32] = "-";
+        if (result.megabytes > 0) {
+            std::snprintf(bandwidth, sizeof(bandwidth), "%.2f MB/s", megabytesPerSecond);
+        }
+        std::snprintf(line, sizeof(line), "%-26s %10.4f s %14.0f %-10s %14s %10.1f MB peak\n",
+                      result.name.c_str(), result.seconds, perSecond, rate.c_str(), bandwidth,
+                      result.peakKb / 1024.0);
+    }
+    cout << line << std::flush;
+}
+
+/**
+ * @brief Builds the settings of one construction stage, leaving the other options at their defaults
+ *
+ * @param mode How the corpus is read
+ * @param threads The number of threads, or 0 for one per hardware thread
+ * @param compress Whether line numbers are stored compressed
+ * @param normalization How tokens are normalized
+ * @return DictionaryOptions The settings
+ */
+static DictionaryOptions ingestOptions(IngestMode mode, unsigned threads, bool compress,
+                                       Normalization normalization = Normalization::Verbatim) {
+    DictionaryOptions settings;
+    settings.mode = mode;
+    settings.threads = threads;
+    settings.compressPostings = compress;
+    settings.normalization = normalization;
+    return settings;
+}
+
+/**
+ * @brief Reads the benchmark settings from the command line
+ *
+ * @param argc The number of arguments
+ * @param argv The arguments
+ * @return BenchmarkOptions The settings
+ */
+static BenchmarkOptions parseOptions(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--keep") {
+            options.keep = true;
+        } else if (arg == "--csv") {
+            options.csv = true;
+        } else if (arg == "--tokens" && hasValue) {
+            options.tokens = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--vocab" && hasValue) {
+            options.vocabulary = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--zipf" && hasValue) {
+            options.zipf = std::strtod(argv[++i], nullptr);
+        } else if (arg == "--words-per-line" && hasValue) {
+            options.wordsPerLine = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--threads" && hasValue) {
+            options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--repeat" && hasValue) {
+            options.repeat = std::atoi(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--corpus" && hasValue) {
+            options.corpusPath = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--tokens N] [--vocab N] [--zipf S] [--words-per-line N]"
+                      << " [--threads N] [--repeat N] [--seed N] [--corpus PATH] [--keep] [--csv]\n";
+            exit(arg == "--help" ? 0 : 1);
+        }
+    }
+    if (options.tokens == 0 || options.vocabulary == 0 || options.wordsPerLine == 0 || options.repeat < 1) {
+        std::cerr << "--tokens, --vocab, --words-per-line and --repeat must be positive\n";
+        exit(1);
+    }
+    if (options.corpusPath.empty()) {
+        options.corpusPath = (std::filesystem::temp_directory_path() /
+                              ("textdictionary-benchmark-" + std::to_string(options.seed) + ".txt")).string();
+    }
+    return options;
+}
+
+/**
+ * @brief Generates the corpus and runs every stage
+ *
+ * @return int Returns 0 if the benchmark ran successfully.
+ */
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options = parseOptions(argc, argv);
+    Corpus corpus = generateCorpus(options);
+    writeCorpus(corpus, options, options.corpusPath);
+
+    double tokens = static_cast<double>(corpus.ranks.size());
+    double megabytes = corpus.bytes / (1024.0 * 1024.0);
+    size_t lines = (corpus.ranks.size() + options.wordsPerLine - 1) / options.wordsPerLine;
+    if (options.csv) {
+        cout << "stage,seconds,items_per_second,unit,mb_per_second,peak_kb\n";
+    } else {
+        cout << "corpus: " << corpus.ranks.size() << " words, " << corpus.vocabulary.size() << " vocabulary words, "
+             << lines << " lines, " << megabytes << " MB (zipf " << options.zipf << ", seed " << options.seed
+             << ")\n";
+    }
+
+    struct Mode {
+        const char* name;
+        DictionaryOptions settings;
+    };
+    const Mode modes[] = {
+        { "construct/stream", ingestOptions(IngestMode::Stream, 0, false) },
+        { "construct/mapped", ingestOptions(IngestMode::Mapped, 0, false) },
+        { "construct/parallel", ingestOptions(IngestMode::Parallel, options.threads, false) },
+        { "construct/bulk", ingestOptions(IngestMode::Bulk, options.threads, false) },
+        { "construct/mapped+compress", ingestOptions(IngestMode::Mapped, 0, true) },
+        { "construct/mapped+normalize", ingestOptions(IngestMode::Mapped, 0, false,
+                                                      Normalization::StripPunctuation | Normalization::CaseFold) },
+    };
+    for (const Mode& mode : modes) {
+        report(measure(mode.name, tokens, "words", megabytes, options.repeat, [&] {
+            Dictionary dictionary(options.corpusPath, mode.settings);
+        }), options.csv);
+    }
+
+    // index straight into a snapshot with a budget of an eighth of the corpus, so several runs are spilled and merged
+    {
+        DictionaryOptions settings;
+        settings.memoryBudget = corpus.bytes / 8;
+        string snapshotPath = options.corpusPath + ".snapshot";
+        report(measure("Dictionary::buildSnapshot/spill", tokens, "words", megabytes, options.repeat, [&] {
+            Dictionary::buildSnapshot(options.corpusPath, snapshotPath, settings);
+        }), options.csv);
+        std::remove(snapshotPath.c_str());
+    }
+
+    // addSorted with every token of the corpus, in corpus order, into one list
+    report(measure("WordList::addSorted", tokens, "words", megabytes, options.repeat, [&] {
+        WordList list;
+        for (size_t i = 0; i < corpus.ranks.size(); ++i) {
+            list.addSorted(corpus.vocabulary[corpus.ranks[i]], static_cast<int>(i / options.wordsPerLine + 1));
+        }
+    }), options.csv);
+
+    // search for every token of the corpus, plus an equal number of misses, in a list of the whole vocabulary
+    {
+        WordList list;
+        for (const string& word : corpus.vocabulary) {
+            list.addSorted(word, 1);
+        }
+        std::vector<Word> queries;
+        queries.reserve(corpus.vocabulary.size() * 2);
+        for (const string& word : corpus.vocabulary) {
+            queries.emplace_back(std::string_view(word), 1);
+            queries.emplace_back(std::string_view(word + "~"), 1);
+        }
+        size_t found = 0;
+        report(measure("WordList::search", tokens * 2, "lookups", 0, options.repeat, [&] {
+            for (size_t i = 0; i < corpus.ranks.size(); ++i) {
+                found += list.search(queries[corpus.ranks[i] * 2]);
+                found += list.search(queries[corpus.ranks[(i * 7919) % corpus.ranks.size()] * 2 + 1]);
+            }
+        }), options.csv);
+        if (found != corpus.ranks.size() * options.repeat) {
+            std::cerr << "WordList::search returned wrong results\n";
+            return 1;
+        }
+    }
+
+    // append the line numbers of every token to the list of its word, plain and compressed
+    for (bool compressed : { false, true }) {
+        report(measure(compressed ? "NumList::append/compressed" : "NumList::append", tokens, "values", 0,
+                       options.repeat, [&] {
+            std::vector<NumList> postings(corpus.vocabulary.size());
+            if (compressed) {
+                for (NumList& list : postings) {
+                    list.compress();
+                }
+            }
+            for (size_t i = 0; i < corpus.ranks.size(); ++i) {
+                postings[corpus.ranks[i]].append(static_cast<int>(i / options.wordsPerLine + 1));
+            }
+        }), options.csv);
+    }
+
+    // look up every token of the corpus through the hash index, one at a time and in batches,
+    // then print the dictionary to a stream that discards the text
+    {
+        Dictionary dictionary(options.corpusPath, IngestMode::Mapped);
+        long total = 0;
+        report(measure("Dictionary::frequency", tokens, "lookups", 0, options.repeat, [&] {
+            for (unsigned rank : corpus.ranks) {
+                total += dictionary.frequency(corpus.vocabulary[rank]);
+            }
+        }), options.csv);
+        if (total == 0) {
+            std::cerr << "Dictionary::frequency returned wrong results\n";
+            return 1;
+        }
+
+        size_t topCount = 0;
+        report(measure("Dictionary::topWords(100)", 1000, "queries", 0, options.repeat, [&] {
+            for (int i = 0; i < 1000; ++i) {
+                topCount += dictionary.topWords(100).size();
+            }
+        }), options.csv);
+        if (topCount == 0) {
+            std::cerr << "Dictionary::topWords returned wrong results\n";
+            return 1;
+        }
+
+        std::vector<std::string_view> keys;
+        keys.reserve(corpus.ranks.size());
+        for (unsigned rank : corpus.ranks) {
+            keys.push_back(corpus.vocabulary[rank]);
+        }
+        std::vector<const Word*> found(keys.size());
+        report(measure("Dictionary::findBatch", tokens, "lookups", 0, options.repeat, [&] {
+            for (size_t first = 0; first < keys.size(); first += 1024) {
+                dictionary.findBatch(keys.data() + first, std::min<size_t>(1024, keys.size() - first),
+                                     found.data() + first);
+            }
+        }), options.csv);
+        if (std::count(found.begin(), found.end(), nullptr) != 0) {
+            std::cerr << "Dictionary::findBatch returned wrong results\n";
+            return 1;
+        }
+
+        NullBuffer discard;
+        std::ostream out(&discard);
+        std::ostringstream sizing;
+        dictionary.print(sizing);
+        string text = sizing.str();
+        double printed = text.size() / (1024.0 * 1024.0);
+        double words = static_cast<double>(std::count(text.begin(), text.end(), '\n'));
+        text = string();
+        report(measure("Dictionary::print", words, "words", printed,
+                       options.repeat, [&] {
+            dictionary.print(out);
+        }), options.csv);
+
+        // lay the nodes out in print order, then print again
+        report(measure("Dictionary::compact", words, "words", 0, 1, [&] {
+            dictionary.compact();
+        }), options.csv);
+        report(measure("Dictionary::print/compacted", words, "words", printed,
+                       options.repeat, [&] {
+            dictionary.print(out);
+        }), options.csv);
+
+        // merge a copy in as if a second process had indexed the corpus again, following the first one
+        Dictionary second(dictionary);
+        report(measure("Dictionary::merge", words, "words", 0, 1, [&] {
+            dictionary.merge(second, static_cast<int>(lines), options.threads);
+        }), options.csv);
+    }
+
+    if (!options.keep) {
+        std::remove(options.corpusPath.c_str());
+    }
+    return 0;
+}
@@ -0,0 +1,221 @@
+#include "ConcurrentDictionary.h"
+#include "OutputBuffer.h"
+
+/**
+ * Constructor that copies a bucket of the writer's Dictionary.
+ * @param source The bucket to copy.
+ */
+ConcurrentDictionary::Bucket::Bucket(const WordBucket& source) {
+    words.setArena(&arena);
+    words = source;
+}
+
+/**
+ * Constructor that creates an empty ConcurrentDictionary.
+ * @param options How the words are stored (the ingest settings are ignored).
+ * @param minPublishBytes Lower bound on the text added between two automatic publications, in bytes.
+ */
+ConcurrentDictionary::ConcurrentDictionary(const DictionaryOptions& options, size_t minPublishBytes)
+        : writer(options), minPublishBytes(minPublishBytes), current(nullptr) {
+    std::shared_ptr<const Bucket> empty = std::make_shared<const Bucket>(WordBucket());
+    Version* first = new Version();
+    for (auto& bucket : first->buckets) {
+        bucket = empty;
+    }
+    current.store(first);
+}
+
+/**
+ * Destructor. No Snapshot may outlive the ConcurrentDictionary.
+ */
+ConcurrentDictionary::~ConcurrentDictionary() {
+    delete current.load();
+}
+
+/**
+ * Adds one occurrence of a word, like Dictionary::processWord. Safe to call from several threads.
+ * @param word The word to add.
+ * @param linenum The line number where the word was found.
+ */
+void ConcurrentDictionary::processWord(std::string_view word, int linenum) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    // Normalization may move the word to another bucket than its first character suggests, or drop it
+    size_t bucket = writer.processWord(word, linenum);
+    if (bucket < Dictionary::kBucketCount) {
+        dirtyBuckets |= uint32_t(1) << bucket;
+    }
+    pendingBytes += word.size() + 1;
+    maybePublish();
+}
+
+/**
+ * Adds the words of the next chunk of a text, like Dictionary::ingest. Safe to call from several threads,
+ * but chunks of one text must arrive in order.
+ * @param chunk The next piece of the text.
+ */
+void ConcurrentDictionary::ingest(std::string_view chunk) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    writer.ingest(chunk);
+    dirtyBuckets = (uint32_t(1) << Dictionary::kBucketCount) - 1; // Any bucket may have changed
+    pendingBytes += chunk.size();
+    maybePublish();
+}
+
+/**
+ * Ends the current text, like Dictionary::finish, and publishes everything added so far.
+ */
+void ConcurrentDictionary::finish() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    writer.finish();
+    dirtyBuckets = (uint32_t(1) << Dictionary::kBucketCount) - 1;
+    publishLocked();
+}
+
+/**
+ * Makes every word added so far visible to readers.
+ */
+void ConcurrentDictionary::publish() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    publishLocked();
+}
+
+/**
+ * Publishes the writer's contents if enough text was added since the last version. Requires writerMutex.
+ * Waiting for an eighth of the text indexed so far bounds the total copying to a constant factor of the input.
+ */
+void ConcurrentDictionary::maybePublish() {
+    if (pendingBytes >= minPublishBytes && pendingBytes >= totalBytes / 8) {
+        publishLocked();
+    }
+}
+
+/**
+ * Publishes the writer's contents as a new version. Requires writerMutex.
+ * Changed buckets are copied, the others are shared with the previous version, which is retired.
+ */
+void ConcurrentDictionary::publishLocked() {
+    totalBytes += pendingBytes;
+    pendingBytes = 0;
+    if (dirtyBuckets == 0) {
+        return;
+    }
+    const Version* previous = current.load();
+    Version* next = new Version();
+    for (size_t i = 0; i < Dictionary::kBucketCount; ++i) {
+        if (dirtyBuckets & (uint32_t(1) << i)) {
+            next->buckets[i] = std::make_shared<const Bucket>(writer.getBucket(i));
+        } else {
+            next->buckets[i] = previous->buckets[i];
+        }
+        next->wordCount += next->buckets[i]->words.listSize();
+    }
+    dirtyBuckets = 0;
+
+    current.store(next);
+    epochs.retire(const_cast<Version*>(previous), [](void* version) { delete static_cast<Version*>(version); });
+    epochs.reclaim();
+}
+
+/**
+ * Finds a word in a version.
+ * @param version The version to search.
+ * @param word The word to look for.
+ * @return The Word, or nullptr if it is not in the version.
+ */
+const Word* ConcurrentDictionary::find(const Version& version, std::string_view word) {
+    if (word.empty()) {
+        return nullptr;
+    }
+    return version.buckets[Dictionary::bucketIndex(word)]->words.find(word);
+}
+
+/**
+ * Takes a consistent view of the most recently published version. Never blocks.
+ * @return The snapshot.
+ */
+ConcurrentDictionary::Snapshot ConcurrentDictionary::snapshot() const {
+    return Snapshot(*this);
+}
+
+/**
+ * Checks whether a word is in the most recently published version.
+ * @param word The word to look for.
+ * @return true if the word is visible to readers, false otherwise.
+ */
+bool ConcurrentDictionary::contains(std::string_view word) const {
+    return snapshot().contains(word);
+}
+
+/**
+ * Returns the number of occurrences of a word in the most recently published version.
+ * @param word The word to look for.
+ * @return The frequency of the word, or 0 if it is not visible to readers.
+ */
+int ConcurrentDictionary::frequency(std::string_view word) const {
+    return snapshot().frequency(word);
+}
+
+/**
+ * Constructor that pins the current version of a ConcurrentDictionary.
+ * The guard is entered before the version pointer is read (see EpochManager::Guard).
+ * @param owner The ConcurrentDictionary to view.
+ */
+ConcurrentDictionary::Snapshot::Snapshot(const ConcurrentDictionary& owner)
+        : guard(owner.epochs), version(owner.current.load()) {}
+
+/**
+ * Returns the number of distinct words in the snapshot.
+ * @return The number of words.
+ */
+size_t ConcurrentDictionary::Snapshot::size() const {
+    return version->wordCount;
+}
+
+/**
+ * Checks whether a word is in the snapshot.
+ * @param word The word to look for.
+ * @return true if the word is in the snapshot, false otherwise.
+ */
+bool ConcurrentDictionary::Snapshot::contains(std::string_view word) const {
+    return find(*version, word) != nullptr;
+}
+
+/**
+ * Returns the number of occurrences of a word.
+ * @param word The word to look for.
+ * @return The frequency of the word, or 0 if it is not in the snapshot.
+ */
+int ConcurrentDictionary::Snapshot::frequency(std::string_view word) const {
+    const Word* found = find(*version, word);
+    return found != nullptr ? found->getFrequency() : 0;
+}
+
+/**
+ * Returns the line numbers of a word.
+ * @param word The word to look for.
+ * @return The line numbers, or nullptr if the word is not in the snapshot.
+ */
+const NumList* ConcurrentDictionary::Snapshot::lines(std::string_view word) const {
+    const Word* found = find(*version, word);
+    return found != nullptr ? &found->getNumberList() : nullptr;
+}
+
+/**
+ * Searches for a Word in the snapshot, like WordList::search.
+ * @param aWord The Word to search for.
+ * @return true if the Word is in the snapshot, false otherwise.
+ */
+bool ConcurrentDictionary::Snapshot::search(const Word& aWord) const {
+    return find(*version, std::string_view(aWord.c_str(), aWord.size())) != nullptr;
+}
+
+/**
+ * Prints the snapshot in the same format as Dictionary::print.
+ * @param out The output stream to print to.
+ */
+void ConcurrentDictionary::Snapshot::print(std::ostream& out) const {
+    OutputBuffer buffer(out);
+    for (const auto& bucket : version->buckets) {
+        bucket->words.print(buffer);
+    }
+}
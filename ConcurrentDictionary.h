@@ -0,0 +1,227 @@
+#ifndef CONCURRENTDICTIONARY_H_
+#define CONCURRENTDICTIONARY_H_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include "Arena.h"
+#include "Dictionary.h"
+#include "EpochManager.h"
+#include "WordBucket.h"
+
+/**
+ * The ConcurrentDictionary class lets serving threads query a dictionary while ingestion threads keep adding words.
+ *
+ * Writers add words to a private Dictionary under a writer mutex and periodically publish an immutable version
+ * of it. A version holds one read-only copy of each bucket; buckets that did not change since the previous
+ * version are shared with it rather than copied (copy-on-write per bucket). Readers take a Snapshot, which pins
+ * the current version through an EpochManager: they never lock, never wait for writers and always see every
+ * word of one published version. Replaced versions are deleted once no Snapshot can still see them.
+ *
+ * Words become visible to readers when the writer publishes. That happens automatically once the text added
+ * since the last version reaches a fraction of the text indexed so far, which keeps the copying amortized
+ * constant per word, or explicitly through publish().
+ */
+class ConcurrentDictionary {
+private:
+    /**
+     * A read-only copy of one bucket, with the arena its nodes live in.
+     */
+    struct Bucket {
+        /** Arena holding the copied nodes; declared first so it outlives them */
+        Arena arena;
+
+        /** The copied words, in bucket order */
+        WordBucket words;
+
+        /**
+         * Constructor that copies a bucket of the writer's Dictionary.
+         * @param source The bucket to copy.
+         */
+        explicit Bucket(const WordBucket& source);
+    };
+
+    /**
+     * A published version of the dictionary.
+     */
+    struct Version {
+        /** The buckets, shared with other versions where unchanged */
+        std::shared_ptr<const Bucket> buckets[Dictionary::kBucketCount];
+
+        /** The number of distinct words */
+        size_t wordCount{ 0 };
+    };
+
+    /** The dictionary the writers add to */
+    Dictionary writer;
+
+    /** Serializes writers; readers never take it */
+    mutable std::mutex writerMutex;
+
+    /** Bit i is set if bucket i changed since the last published version */
+    uint32_t dirtyBuckets{ 0 };
+
+    /** Bytes of text added since the last published version */
+    size_t pendingBytes{ 0 };
+
+    /** Bytes of text added in total */
+    size_t totalBytes{ 0 };
+
+    /** Lower bound on the text added between two automatic publications, in bytes */
+    size_t minPublishBytes;
+
+    /** The version readers see */
+    std::atomic<const Version*> current;
+
+    /** Reclaims replaced versions once no reader can see them */
+    mutable EpochManager epochs;
+
+    /**
+     * Publishes the writer's contents if enough text was added since the last version. Requires writerMutex.
+     */
+    void maybePublish();
+
+    /**
+     * Publishes the writer's contents as a new version. Requires writerMutex.
+     */
+    void publishLocked();
+
+    /**
+     * Finds a word in a version.
+     * @param version The version to search.
+     * @param word The word to look for.
+     * @return The Word, or nullptr if it is not in the version.
+     */
+    static const Word* find(const Version& version, std::string_view word);
+
+public:
+    /** Default lower bound on the text added between two automatic publications, in bytes */
+    static constexpr size_t kDefaultMinPublishBytes = 1 << 20;
+
+    /**
+     * A consistent, read-only view of one published version.
+     * Pointers and references obtained from a Snapshot stay valid until the Snapshot is destroyed.
+     */
+    class Snapshot {
+    private:
+        /** Keeps the version alive */
+        EpochManager::Guard guard;
+
+        /** The version being viewed */
+        const Version* version;
+
+        friend class ConcurrentDictionary;
+
+        /**
+         * Constructor that pins the current version of a ConcurrentDictionary.
+         * @param owner The ConcurrentDictionary to view.
+         */
+        explicit Snapshot(const ConcurrentDictionary& owner);
+
+    public:
+        /**
+         * Returns the number of distinct words in the snapshot.
+         * @return The number of words.
+         */
+        size_t size() const;
+
+        /**
+         * Checks whether a word is in the snapshot.
+         * @param word The word to look for.
+         * @return true if the word is in the snapshot, false otherwise.
+         */
+        bool contains(std::string_view word) const;
+
+        /**
+         * Returns the number of occurrences of a word.
+         * @param word The word to look for.
+         * @return The frequency of the word, or 0 if it is not in the snapshot.
+         */
+        int frequency(std::string_view word) const;
+
+        /**
+         * Returns the line numbers of a word.
+         * @param word The word to look for.
+         * @return The line numbers, or nullptr if the word is not in the snapshot.
+         */
+        const NumList* lines(std::string_view word) const;
+
+        /**
+         * Searches for a Word in the snapshot, like WordList::search.
+         * @param aWord The Word to search for.
+         * @return true if the Word is in the snapshot, false otherwise.
+         */
+        bool search(const Word& aWord) const;
+
+        /**
+         * Prints the snapshot in the same format as Dictionary::print.
+         * @param out The output stream to print to.
+         */
+        void print(std::ostream& out) const;
+    };
+
+    /**
+     * Constructor that creates an empty ConcurrentDictionary.
+     * @param options How the words are stored (the ingest settings are ignored).
+     * @param minPublishBytes Lower bound on the text added between two automatic publications, in bytes.
+     */
+    explicit ConcurrentDictionary(const DictionaryOptions& options = DictionaryOptions(),
+                                  size_t minPublishBytes = kDefaultMinPublishBytes);
+
+    /**
+     * Destructor. No Snapshot may outlive the ConcurrentDictionary.
+     */
+    ~ConcurrentDictionary();
+
+    ConcurrentDictionary(const ConcurrentDictionary&) = delete;
+    ConcurrentDictionary& operator=(const ConcurrentDictionary&) = delete;
+
+    /**
+     * Adds one occurrence of a word, like Dictionary::processWord. Safe to call from several threads.
+     * @param word The word to add.
+     * @param linenum The line number where the word was found.
+     */
+    void processWord(std::string_view word, int linenum);
+
+    /**
+     * Adds the words of the next chunk of a text, like Dictionary::ingest. Safe to call from several threads,
+     * but chunks of one text must arrive in order.
+     * @param chunk The next piece of the text.
+     */
+    void ingest(std::string_view chunk);
+
+    /**
+     * Ends the current text, like Dictionary::finish, and publishes everything added so far.
+     */
+    void finish();
+
+    /**
+     * Makes every word added so far visible to readers.
+     */
+    void publish();
+
+    /**
+     * Takes a consistent view of the most recently published version. Never blocks.
+     * @return The snapshot.
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * Checks whether a word is in the most recently published version.
+     * @param word The word to look for.
+     * @return true if the word is visible to readers, false otherwise.
+     */
+    bool contains(std::string_view word) const;
+
+    /**
+     * Returns the number of occurrences of a word in the most recently published version.
+     * @param word The word to look for.
+     * @return The frequency of the word, or 0 if it is not visible to readers.
+     */
+    int frequency(std::string_view word) const;
+};
+
+#endif /* CONCURRENTDICTIONARY_H_ */
@@ -1,7 +1,20 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <filesystem>
 #include <fstream>
-#include <sstream>
+#include <memory>
+#include <queue>
+#include <stdexcept>
+#include <vector>
 #include <cctype>
 #include "Dictionary.h"
+#include "MappedFile.h"
+#include "OutputBuffer.h"
+#include "Parallel.h"
+#include "SnapshotWriter.h"
+#include "SpillRun.h"
+#include "Tokenizer.h"
 
 /**
  * @brief Determines the bucket index for a word
@@ -9,10 +22,10 @@
  * @param word The word for which the bucket index is required
  * @return size_t The index of the bucket for the given word
  */
-size_t Dictionary::bucketIndex(const string& word) const
+size_t Dictionary::bucketIndex(std::string_view word)
 {
     size_t index = 26;
-    if (isalpha(word[0])) // If the first character of the word is a letter
+    if (!word.empty() && isalpha(static_cast<unsigned char>(word[0]))) // If the first character of the word is a letter
     {
         index = toupper(word[0]) - 'A'; // Bucket index is determined based on the alphabetical order
     }
@@ -23,14 +36,57 @@ size_t Dictionary::bucketIndex(const string& word) const
  * @brief Construct a new Dictionary:: Dictionary object and read words from the input file
  *
  * @param filename The name of the file from which words are read
+ * @param mode How the file is read
+ * @param threads The number of threads for IngestMode::Parallel and IngestMode::Bulk, or 0 for one per hardware thread
  */
-Dictionary::Dictionary(const string& filename) : filename(filename)
+Dictionary::Dictionary(const string& filename, IngestMode mode, unsigned threads)
+    : Dictionary(filename, [&] {
+          DictionaryOptions options;
+          options.mode = mode;
+          options.threads = threads;
+          return options;
+      }())
 {
+}
+
+/**
+ * @brief Construct a new Dictionary:: Dictionary object from the input file with the given settings
+ *
+ * @param filename The name of the file from which words are read
+ * @param options How the file is read and how the words are stored
+ */
+Dictionary::Dictionary(const string& filename, const DictionaryOptions& options)
+    : filename(filename), compressPostings(options.compressPostings), normalization(options.normalization)
+{
+    attachArena();
+    configureBuckets(options);
+    IngestMode mode = options.mode;
+    if (mode != IngestMode::Stream)
+    {
+        MappedFile file(filename);
+        if (!file) // If the file cannot be opened
+        {
+            throw std::runtime_error("could not open input file: " + filename);
+        }
+        if (mode == IngestMode::Parallel)
+        {
+            buildParallel(file.view(), options.threads);
+        }
+        else if (mode == IngestMode::Bulk)
+        {
+            buildBulk(file.view(), options.threads);
+        }
+        else
+        {
+            processText(file.view(), 1);
+        }
+        return;
+    }
+
     std::ifstream fin(filename);
     if (!fin) // If the file cannot be opened
     {
-        std::cout << "could not open input file: " << filename << std::endl;
-        exit(1);
+        throw std::runtime_error("could not open input file: " + filename);
     }
 
     int linenum = 0;
@@ -38,14 +94,641 @@ Dictionary::Dictionary(const string& filename) : filename(filename)
     while (getline(fin, line)) // Read lines from the file
     {
         ++linenum;
-        std::istringstream sin(line);
-        string wordStr;
-        while (sin >> wordStr) // Read words from the line
+        processText(line, linenum); // Split the line into words
+    }
+    fin.close();
+}
+
+/**
+ * @brief Split a block of text on whitespace and process every word in it
+ *
+ * Words are found 64 bytes at a time by the Tokenizer, which counts line breaks in the same pass, and are
+ * handed to addWord as views into the text, so nothing is copied unless the word is new. The normalization
+ * steps are resolved to a template instantiation once for the whole block, so the loop over the words has no
+ * branches on the settings and verbatim words go straight to addWord.
+ *
+ * @param text The text to process, lines separated by '\n'
+ * @param linenum The line number of the first line in text
+ * @return int The line number the text following this block would start on
+ */
+int Dictionary::processText(std::string_view text, int linenum)
+{
+    return Normalizer::dispatch(normalization, [&](auto steps) {
+        constexpr unsigned kSteps = decltype(steps)::value;
+        std::string scratch;
+        return Tokenizer::forEachWord(text, linenum, [&](std::string_view word, int line) {
+            word = Normalizer::apply<kSteps>(word, scratch);
+            if (kSteps == 0 || !word.empty())
+            {
+                addWord(word, line);
+            }
+        });
+    });
+}
+
+/**
+ * @brief Build the dictionary from a whole file using one shard per thread
+ *
+ * The text is cut into one slice per thread at line boundaries. A first parallel pass counts the lines
+ * of each slice so every shard knows the absolute number of its first line. Each thread then fills a
+ * private Dictionary from its slice without any locking. Finally the shards are merged bucket by bucket,
+ * pairwise in a tree so that line numbers stay in order, with the buckets themselves merged in parallel.
+ *
+ * @param text The contents of the file
+ * @param threads The number of threads to use, or 0 for one per hardware thread
+ */
+void Dictionary::buildParallel(std::string_view text, unsigned threads)
+{
+    size_t shardCount = std::min<size_t>(workerCount(threads), std::max<size_t>(text.size() / 4096, 1));
+    if (shardCount == 1)
+    {
+        processText(text, 1);
+        return;
+    }
+
+    std::vector<int> firstLine;
+    std::vector<std::string_view> slices = sliceLines(text, shardCount, threads, firstLine);
+
+    // Every shard allocates from its own arena, so the threads never share an allocator
+    DictionaryOptions shardOptions;
+    shardOptions.compressPostings = compressPostings;
+    shardOptions.normalization = normalization;
+    shardOptions.bucketPrefixBytes = wordListBuckets[0].getPrefixBytes();
+    shardOptions.bucketSplitThreshold = wordListBuckets[0].getSplitThreshold();
+    std::vector<std::unique_ptr<Dictionary>> shards(shardCount);
+    parallelFor(threads, shardCount, [&](size_t i) {
+        shards[i].reset(new Dictionary(shardOptions));
+        shards[i]->processText(slices[i], firstLine[i]);
+    });
+
+    // Merge neighbouring shards pairwise so earlier lines always stay in front
+    parallelFor(threads, kBucketCount, [&](size_t bucket) {
+        for (size_t step = 1; step < shardCount; step *= 2)
         {
-            processWord(wordStr, linenum);
+            for (size_t i = 0; i + step < shardCount; i += 2 * step)
+            {
+                shards[i]->wordListBuckets[bucket].merge(std::move(shards[i + step]->wordListBuckets[bucket]));
+            }
         }
+        wordListBuckets[bucket] = std::move(shards[0]->wordListBuckets[bucket]);
+        wordListBuckets[bucket].setArena(arena.get());
+    });
+
+    // The merged nodes still live in the shard arenas, which this Dictionary now takes over
+    for (auto& shard : shards)
+    {
+        arena->adopt(*shard->arena);
     }
-    fin.close();
+    reindex();
+}
+
+/**
+ * @brief Cut a text into slices of whole lines and number the first line of each
+ *
+ * The cuts are placed just after the first line break following each even share of the text. A parallel
+ * pass then counts the lines of every slice, and a prefix sum turns the counts into line numbers.
+ *
+ * @param text The text to cut
+ * @param sliceCount The number of slices wanted
+ * @param threads The number of threads for counting lines, or 0 for one per hardware thread
+ * @param firstLine Receives the number of the first line of every slice, plus one entry past the last slice
+ * @return std::vector<std::string_view> The slices, each ending just after a line break except the last one
+ */
+std::vector<std::string_view> Dictionary::sliceLines(std::string_view text, size_t sliceCount, unsigned threads,
+                                                     std::vector<int>& firstLine)
+{
+    // Cut the text into slices that end just after a line break
+    std::vector<std::string_view> slices;
+    size_t start = 0;
+    for (size_t i = 1; i <= sliceCount; ++i)
+    {
+        size_t cut = text.size();
+        if (i < sliceCount)
+        {
+            cut = std::max(start, text.size() / sliceCount * i);
+            const void* newline = std::memchr(text.data() + cut, '\n', text.size() - cut);
+            cut = newline ? static_cast<const char*>(newline) - text.data() + 1 : text.size();
+        }
+        slices.push_back(text.substr(start, cut - start));
+        start = cut;
+    }
+
+    // Number of the first line of every slice
+    firstLine.assign(sliceCount + 1, 0);
+    parallelFor(threads, sliceCount, [&](size_t i) {
+        firstLine[i + 1] = static_cast<int>(std::count(slices[i].begin(), slices[i].end(), '\n'));
+    });
+    firstLine[0] = 1;
+    for (size_t i = 1; i <= sliceCount; ++i)
+    {
+        firstLine[i] += firstLine[i - 1];
+    }
+
+    return slices;
+}
+
+/**
+ * @brief Orders postings by word, in the same order as Word::compare, and then by line
+ *
+ * @param a The first posting
+ * @param b The second posting
+ * @return true if a sorts before b
+ */
+bool Dictionary::postingBefore(const Posting& a, const Posting& b)
+{
+    if (a.prefix != b.prefix)
+    {
+        return a.prefix < b.prefix;
+    }
+    // Equal prefixes mean the first eight characters match, so only the rest needs reading
+    uint32_t common = std::min(a.length, b.length);
+    if (common > sizeof(a.prefix))
+    {
+        int result = std::memcmp(a.chars + sizeof(a.prefix), b.chars + sizeof(b.prefix), common - sizeof(a.prefix));
+        if (result != 0)
+        {
+            return result < 0;
+        }
+    }
+    if (a.length != b.length)
+    {
+        return a.length < b.length;
+    }
+    return a.line < b.line;
+}
+
+/**
+ * @brief Sort postings by word with a stable most-significant-byte radix sort on their prefixes
+ *
+ * Each pass counts the postings per value of one prefix byte, scatters them into the buffer in that order
+ * and copies them back, then sorts every group on the next byte. Passes where all postings share the byte
+ * are skipped. Small groups, and groups whose whole prefix is equal, are finished with a comparison sort
+ * that breaks ties on the line, unless they all hold the same short word and are therefore already in order.
+ *
+ * @param postings The postings to sort
+ * @param buffer Scratch space for at least count postings
+ * @param count The number of postings
+ * @param byte The index of the prefix byte to sort on; the bytes before it are equal in all postings
+ */
+void Dictionary::sortPostings(Posting* postings, Posting* buffer, size_t count, unsigned byte)
+{
+    constexpr size_t kSmallGroup = 32;
+    if (count < kSmallGroup || byte == sizeof(uint64_t))
+    {
+        bool sameShortWord = std::all_of(postings, postings + count, [&](const Posting& posting) {
+            return posting.length == postings[0].length && posting.length <= sizeof(uint64_t) &&
+                   posting.prefix == postings[0].prefix;
+        });
+        if (!sameShortWord)
+        {
+            std::sort(postings, postings + count, postingBefore);
+        }
+        return;
+    }
+
+    unsigned shift = 8 * (sizeof(uint64_t) - 1 - byte);
+    size_t offsets[257] = {};
+    for (size_t i = 0; i < count; ++i)
+    {
+        ++offsets[((postings[i].prefix >> shift) & 0xff) + 1];
+    }
+    if (offsets[((postings[0].prefix >> shift) & 0xff) + 1] == count) // All postings share this byte
+    {
+        sortPostings(postings, buffer, count, byte + 1);
+        return;
+    }
+    for (size_t value = 1; value <= 256; ++value)
+    {
+        offsets[value] += offsets[value - 1];
+    }
+    size_t next[256];
+    std::copy(offsets, offsets + 256, next);
+    for (size_t i = 0; i < count; ++i)
+    {
+        buffer[next[(postings[i].prefix >> shift) & 0xff]++] = postings[i];
+    }
+    std::copy(buffer, buffer + count, postings);
+    for (size_t value = 0; value < 256; ++value)
+    {
+        size_t groupSize = offsets[value + 1] - offsets[value];
+        if (groupSize > 1)
+        {
+            sortPostings(postings + offsets[value], buffer, groupSize, byte + 1);
+        }
+    }
+}
+
+/**
+ * @brief Checks whether two postings are occurrences of the same word
+ *
+ * @param a The first posting
+ * @param b The second posting
+ * @return true if both postings have the same characters
+ */
+bool Dictionary::sameWord(const Posting& a, const Posting& b)
+{
+    return a.prefix == b.prefix && a.length == b.length && std::memcmp(a.chars, b.chars, a.length) == 0;
+}
+
+/**
+ * @brief Tokenize and normalize a block of text into postings, split by bucket
+ *
+ * Postings point into the text, so it must outlive them. Words that normalization rewrote are copied into
+ * the scratch arena, since the normalizer reuses its buffer for the next word.
+ *
+ * @param text The text to tokenize, lines separated by '\n'
+ * @param linenum The line number of the first line in text
+ * @param normalization The steps every token goes through
+ * @param buckets kBucketCount arrays the postings are appended to
+ * @param scratchArena Storage for rewritten words
+ * @return int The line number the text following this block would start on
+ */
+int Dictionary::collectPostings(std::string_view text, int linenum, Normalization normalization,
+                                std::vector<Posting>* buckets, Arena& scratchArena)
+{
+    return Normalizer::dispatch(normalization, [&](auto steps) {
+        constexpr unsigned kSteps = decltype(steps)::value;
+        std::string scratch;
+        return Tokenizer::forEachWord(text, linenum, [&](std::string_view word, int line) {
+            word = Normalizer::apply<kSteps>(word, scratch);
+            if (kSteps != 0)
+            {
+                if (word.empty())
+                {
+                    return;
+                }
+                if (word.data() == scratch.data()) // Rewritten in scratch, which the next word reuses
+                {
+                    word = std::string_view(scratchArena.copyString(word), word.size());
+                }
+            }
+            buckets[bucketIndex(word)].push_back(
+                Posting{ Word::prefixOf(word), word.data(), static_cast<uint32_t>(word.size()), line });
+        });
+    });
+}
+
+/**
+ * @brief Build the dictionary from a whole file by sorting all of its postings at once
+ *
+ * This is the classic inverted-index build. Rather than keeping every list sorted as words arrive, each
+ * thread tokenizes a slice of whole lines and appends a (word, line) posting to a flat array per bucket,
+ * which is the first digit of a radix sort. The arrays of each bucket are then gathered and sorted, one
+ * bucket per task, by word and line. Equal words now sit next to each other with their lines in order,
+ * so one linear pass turns every run into a Word and appends it to a list that is already in order.
+ * Postings point into the mapped text; only words changed by normalization are copied, into scratch
+ * arenas that are released once the buckets are built.
+ *
+ * @param text The contents of the file
+ * @param threads The number of threads to use, or 0 for one per hardware thread
+ */
+void Dictionary::buildBulk(std::string_view text, unsigned threads)
+{
+    size_t sliceCount = std::min<size_t>(workerCount(threads), std::max<size_t>(text.size() / 4096, 1));
+    std::vector<int> firstLine;
+    std::vector<std::string_view> slices = sliceLines(text, sliceCount, threads, firstLine);
+
+    // Collect the postings of every slice, split by bucket
+    std::vector<std::vector<Posting>> collected(sliceCount * kBucketCount);
+    std::vector<std::unique_ptr<Arena>> scratchArenas(sliceCount);
+    parallelFor(threads, sliceCount, [&](size_t i) {
+        scratchArenas[i].reset(new Arena());
+        collectPostings(slices[i], firstLine[i], normalization, &collected[i * kBucketCount], *scratchArenas[i]);
+    });
+
+    // Sort every bucket and turn each run of equal words into one Word
+    std::vector<std::unique_ptr<Arena>> bucketArenas(kBucketCount);
+    parallelFor(threads, kBucketCount, [&](size_t bucket) {
+        size_t total = 0;
+        for (size_t i = 0; i < sliceCount; ++i)
+        {
+            total += collected[i * kBucketCount + bucket].size();
+        }
+        std::vector<Posting> postings;
+        postings.reserve(total);
+        for (size_t i = 0; i < sliceCount; ++i)
+        {
+            std::vector<Posting>& part = collected[i * kBucketCount + bucket];
+            postings.insert(postings.end(), part.begin(), part.end());
+            std::vector<Posting>().swap(part);
+        }
+        std::vector<Posting> buffer(postings.size());
+        sortPostings(postings.data(), buffer.data(), postings.size());
+        std::vector<Posting>().swap(buffer);
+
+        bucketArenas[bucket].reset(new Arena());
+        Arena& bucketArena = *bucketArenas[bucket];
+        WordList words;
+        words.setArena(&bucketArena);
+        WordList::Appender appender(words);
+        for (size_t first = 0; first < postings.size();)
+        {
+            const Posting& posting = postings[first];
+            Word word(std::string_view(posting.chars, posting.length), posting.line, bucketArena);
+            if (compressPostings)
+            {
+                word.compressNumbers();
+            }
+            size_t next = first + 1;
+            for (; next < postings.size() && sameWord(postings[next], posting); ++next)
+            {
+                word.appendNumber(postings[next].line);
+            }
+            appender.append(std::move(word));
+            first = next;
+        }
+        wordListBuckets[bucket].assign(std::move(words));
+    });
+
+    // The new nodes live in the bucket arenas, which this Dictionary now takes over
+    for (auto& bucketArena : bucketArenas)
+    {
+        arena->adopt(*bucketArena);
+    }
+    reindex();
+}
+
+/**
+ * @brief Construct a copy of another Dictionary
+ *
+ * @param other The Dictionary to copy
+ */
+Dictionary::Dictionary(const Dictionary& other)
+    : filename(other.filename), compressPostings(other.compressPostings), normalization(other.normalization),
+      pendingWord(other.pendingWord), ingestLine(other.ingestLine)
+{
+    attachArena();
+    for (size_t i = 0; i < kBucketCount; ++i)
+    {
+        wordListBuckets[i] = other.wordListBuckets[i];
+    }
+    reindex();
+}
+
+/**
+ * @brief Replace the contents of this Dictionary with a copy of another one
+ *
+ * @param other The Dictionary to copy
+ * @return Dictionary& A reference to this Dictionary
+ */
+Dictionary& Dictionary::operator=(const Dictionary& other)
+{
+    if (this != &other)
+    {
+        filename = other.filename;
+        compressPostings = other.compressPostings;
+        normalization = other.normalization;
+        pendingWord = other.pendingWord;
+        ingestLine = other.ingestLine;
+        for (size_t i = 0; i < kBucketCount; ++i)
+        {
+            wordListBuckets[i] = other.wordListBuckets[i];
+        }
+        reindex();
+    }
+    return *this;
+}
+
+/**
+ * @brief Replace the contents of this Dictionary with those of another one
+ *
+ * The buckets are moved first so their old nodes are destroyed while the old arena still exists.
+ *
+ * @param other The Dictionary to move from
+ * @return Dictionary& A reference to this Dictionary
+ */
+Dictionary& Dictionary::operator=(Dictionary&& other)
+{
+    if (this != &other)
+    {
+        filename = std::move(other.filename);
+        compressPostings = other.compressPostings;
+        normalization = other.normalization;
+        pendingWord = std::move(other.pendingWord);
+        ingestLine = other.ingestLine;
+        for (size_t i = 0; i < kBucketCount; ++i)
+        {
+            wordListBuckets[i] = std::move(other.wordListBuckets[i]);
+        }
+        wordTable = std::move(other.wordTable);
+        frequencyIndex = std::move(other.frequencyIndex);
+        arena = std::move(other.arena);
+    }
+    return *this;
+}
+
+/**
+ * @brief Create an empty Dictionary whose buckets allocate from its own arena
+ */
+Dictionary::Dictionary()
+{
+    attachArena();
+}
+
+/**
+ * @brief Create an empty Dictionary that stores words with the given settings
+ *
+ * @param options How the words are stored
+ */
+Dictionary::Dictionary(const DictionaryOptions& options)
+    : compressPostings(options.compressPostings), normalization(options.normalization)
+{
+    attachArena();
+    configureBuckets(options);
+}
+
+/**
+ * @brief Add the words of the next chunk of a text that arrives piece by piece
+ *
+ * Only the text up to the last whitespace in the chunk is processed. The rest is the start of a word that
+ * may continue in the next chunk, so it is kept in pendingWord until that chunk arrives.
+ *
+ * @param chunk The next piece of the text
+ */
+void Dictionary::ingest(std::string_view chunk)
+{
+    size_t cut = chunk.size();
+    while (cut > 0 && !Tokenizer::isSeparator(chunk[cut - 1]))
+    {
+        --cut;
+    }
+    if (cut == 0) // No whitespace: the whole chunk continues the pending word
+    {
+        pendingWord.append(chunk.data(), chunk.size());
+        return;
+    }
+
+    size_t start = 0;
+    if (!pendingWord.empty()) // Complete the word cut off by the previous chunk
+    {
+        while (!Tokenizer::isSeparator(chunk[start]))
+        {
+            ++start;
+        }
+        pendingWord.append(chunk.data(), start);
+        processWord(pendingWord, ingestLine);
+        pendingWord.clear();
+    }
+    ingestLine = processText(chunk.substr(start, cut - start), ingestLine);
+    pendingWord.assign(chunk.data() + cut, chunk.size() - cut);
+}
+
+/**
+ * @brief Add the words of everything left in an input stream
+ *
+ * @param in The input stream to read until end of file
+ */
+void Dictionary::ingest(std::istream& in)
+{
+    std::vector<char> buffer(1 << 16);
+    while (in)
+    {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        size_t got = static_cast<size_t>(in.gcount());
+        if (got == 0)
+        {
+            break;
+        }
+        ingest(std::string_view(buffer.data(), got));
+    }
+}
+
+/**
+ * @brief End the current text, adding the word cut off at its end
+ */
+void Dictionary::finish()
+{
+    if (!pendingWord.empty())
+    {
+        processWord(pendingWord, ingestLine);
+        pendingWord.clear();
+    }
+}
+
+/**
+ * @brief Re-lay the words out in print order in a fresh arena
+ *
+ * Every node is moved into the new arena in bucket order; the old arena, including any shard arenas it
+ * adopted, is then released as a whole. The indexes still point at the old Words, so they are rebuilt.
+ */
+void Dictionary::compact()
+{
+    std::unique_ptr<Arena> fresh(new Arena());
+    for (auto& bucket : wordListBuckets)
+    {
+        bucket.compact(*fresh);
+    }
+    arena = std::move(fresh);
+    reindex();
+}
+
+/**
+ * @brief Merge the words of another Dictionary into this one
+ *
+ * The buckets are independent, so they are merged in parallel. Every bucket allocates the copies it makes
+ * from an arena of its own while it is merged, since the Dictionary's arena is not shared between threads;
+ * the bucket arenas are then taken over and the indexes rebuilt. Copied Words keep the other Dictionary's
+ * encoding of their line numbers, so they are re-encoded where it differs from this one's.
+ * A word either Dictionary still holds back from an unfinished ingest is added as a whole word.
+ *
+ * @param other The Dictionary to merge in
+ * @param lineOffset The amount added to each line number taken from other
+ * @param threads The number of threads to use, or 0 for one per hardware thread
+ */
+void Dictionary::merge(const Dictionary& other, int lineOffset, unsigned threads)
+{
+    finish();
+    if (this == &other)
+    {
+        merge(Dictionary(other), lineOffset, threads);
+        return;
+    }
+    std::vector<std::unique_ptr<Arena>> bucketArenas(kBucketCount);
+    parallelFor(threads, kBucketCount, [&](size_t bucket) {
+        bucketArenas[bucket].reset(new Arena());
+        wordListBuckets[bucket].setArena(bucketArenas[bucket].get());
+        wordListBuckets[bucket].merge(other.wordListBuckets[bucket], lineOffset);
+        wordListBuckets[bucket].setArena(arena.get());
+        if (compressPostings != other.compressPostings)
+        {
+            for (Word& word : wordListBuckets[bucket])
+            {
+                if (compressPostings)
+                {
+                    word.compressNumbers();
+                }
+                else
+                {
+                    word.decompressNumbers();
+                }
+            }
+        }
+    });
+    for (auto& bucketArena : bucketArenas)
+    {
+        arena->adopt(*bucketArena);
+    }
+    reindex();
+    if (!other.pendingWord.empty()) // Its line is the last one of other, so its number goes after all others
+    {
+        processWord(other.pendingWord, other.ingestLine + lineOffset);
+    }
+}
+
+/**
+ * @brief Point every bucket at this Dictionary's arena
+ */
+void Dictionary::attachArena()
+{
+    for (auto& wordList : wordListBuckets)
+    {
+        wordList.setArena(arena.get());
+    }
+}
+
+/**
+ * @brief Set how every bucket is split into partitions
+ *
+ * @param options The partitioning settings
+ */
+void Dictionary::configureBuckets(const DictionaryOptions& options)
+{
+    for (auto& bucket : wordListBuckets)
+    {
+        bucket.setPartitioning(options.bucketPrefixBytes, options.bucketSplitThreshold);
+    }
+}
+
+/**
+ * @brief Rebuild the hash index and the frequency index so they point at the Words currently in the buckets
+ */
+void Dictionary::reindex()
+{
+    wordTable.clear();
+    std::vector<const Word*> words;
+    for (auto& wordList : wordListBuckets)
+    {
+        for (Word& word : wordList)
+        {
+            wordTable.insert(&word, WordTable::hashOf(word.c_str(), word.size()), static_cast<uint32_t>(words.size()));
+            words.push_back(&word);
+        }
+    }
+    frequencyIndex.rebuild(words);
+}
+
+/**
+ * @brief Normalize a word the way the words of this Dictionary were
+ *
+ * @param word The word to normalize
+ * @return std::string The normalized word, empty if nothing is left of it
+ */
+std::string Dictionary::normalize(std::string_view word) const
+{
+    return Normalizer::dispatch(normalization, [&](auto steps) {
+        std::string scratch;
+        return std::string(Normalizer::apply<decltype(steps)::value>(word, scratch));
+    });
 }
 
 /**
@@ -53,11 +736,268 @@ Dictionary::Dictionary(const string& filename) : filename(filename)
  *
  * @param word The word to be processed
  * @param linenum The line number where the word was found
+ * @return The index of the bucket the word was added to, or kBucketCount if it was dropped
+ */
+size_t Dictionary::processWord(std::string_view word, int linenum)
+{
+    if (normalization == Normalization::Verbatim)
+    {
+        addWord(word, linenum);
+        return bucketIndex(word);
+    }
+    std::string normalized = normalize(word);
+    if (normalized.empty()) // Punctuation on its own is not a word
+    {
+        return kBucketCount;
+    }
+    addWord(normalized, linenum);
+    return bucketIndex(normalized);
+}
+
+/**
+ * @brief Add an already normalized word to the corresponding bucket
+ *
+ * @param word The word to be added
+ * @param linenum The line number where the word was found
  */
-void Dictionary::processWord(const string& word, int linenum)
+void Dictionary::addWord(std::string_view word, int linenum)
 {
+    size_t hash = WordTable::hashOf(word.data(), word.size());
+    uint32_t id;
+    Word* known = wordTable.find(word.data(), word.size(), hash, id);
+    if (known != nullptr) // The word was seen before, so only the line number is new
+    {
+        known->appendNumber(linenum);
+        frequencyIndex.increment(id);
+        return;
+    }
     size_t index = bucketIndex(word); // Get the bucket index for the word
-    wordListBuckets[index].addSorted(word, linenum); // Add the word to the corresponding bucket
+    Word& added = wordListBuckets[index].addSorted(word, linenum); // Add the word to the corresponding bucket
+    if (compressPostings)
+    {
+        added.compressNumbers();
+    }
+    wordTable.insert(&added, hash, frequencyIndex.add(&added));
+}
+
+/**
+ * @brief Look a word up through the hash index
+ *
+ * @param word The characters of the word
+ * @return const Word* The Word, or nullptr if the word is not in the dictionary
+ */
+const Word* Dictionary::find(std::string_view word) const
+{
+    return wordTable.find(word.data(), word.size(), WordTable::hashOf(word.data(), word.size()));
+}
+
+/**
+ * @brief Look up many words at once
+ *
+ * Each group of kBatchGroup words goes through four passes: hash and prefetch the home slots, prefetch the
+ * Words found there, prefetch their characters, then do the real lookups. Every pass only touches memory the
+ * previous pass asked for, so the misses within a group are served in parallel.
+ *
+ * @param words The words to look up
+ * @param count The number of words
+ * @param results Receives a pointer to each word's Word, or nullptr
+ */
+void Dictionary::findBatch(const std::string_view* words, size_t count, const Word** results) const
+{
+    constexpr size_t kBatchGroup = 32;
+    size_t hashes[kBatchGroup];
+    for (size_t first = 0; first < count; first += kBatchGroup)
+    {
+        size_t group = std::min(kBatchGroup, count - first);
+        const std::string_view* keys = words + first;
+        for (size_t i = 0; i < group; ++i)
+        {
+            hashes[i] = WordTable::hashOf(keys[i].data(), keys[i].size());
+            wordTable.prefetchSlot(hashes[i]);
+        }
+        for (size_t i = 0; i < group; ++i)
+        {
+            wordTable.prefetchWord(hashes[i]);
+        }
+        for (size_t i = 0; i < group; ++i)
+        {
+            wordTable.prefetchCharacters(hashes[i]);
+        }
+        for (size_t i = 0; i < group; ++i)
+        {
+            results[first + i] = wordTable.find(keys[i].data(), keys[i].size(), hashes[i]);
+        }
+    }
+}
+
+/**
+ * @brief Look up many words at once
+ *
+ * @param words The words to look up
+ * @return std::vector<const Word*> A pointer to each word's Word, or nullptr
+ */
+std::vector<const Word*> Dictionary::findBatch(const std::vector<std::string_view>& words) const
+{
+    std::vector<const Word*> results(words.size());
+    findBatch(words.data(), words.size(), results.data());
+    return results;
+}
+
+/**
+ * @brief Get the number of occurrences of a word
+ *
+ * @param word The characters of the word
+ * @return int The frequency of the word, or 0 if it is not in the dictionary
+ */
+int Dictionary::frequency(std::string_view word) const
+{
+    const Word* found = find(word);
+    return found != nullptr ? found->getFrequency() : 0;
+}
+
+/**
+ * @brief Get the line numbers of a word without copying them
+ *
+ * @param word The characters of the word
+ * @return const NumList* The line numbers, or nullptr if the word is not in the dictionary
+ */
+const NumList* Dictionary::lines(std::string_view word) const
+{
+    const Word* found = find(word);
+    return found != nullptr ? &found->getNumberList() : nullptr;
+}
+
+/**
+ * @brief Find the lines on which every one of several words occurs
+ *
+ * @param words The words
+ * @return NumList The shared line numbers, empty if any word is missing
+ */
+NumList Dictionary::linesWithAll(const std::vector<std::string_view>& words) const
+{
+    std::vector<const NumList*> lists;
+    for (std::string_view word : words)
+    {
+        const NumList* found = lines(word);
+        if (found == nullptr) // A missing word occurs on no line
+        {
+            return NumList();
+        }
+        lists.push_back(found);
+    }
+    return NumList::intersectionOf(lists);
+}
+
+/**
+ * @brief Find the lines on which at least one of several words occurs
+ *
+ * @param words The words
+ * @return NumList The line numbers of all the words
+ */
+NumList Dictionary::linesWithAny(const std::vector<std::string_view>& words) const
+{
+    std::vector<const NumList*> lists;
+    for (std::string_view word : words)
+    {
+        const NumList* found = lines(word);
+        if (found != nullptr)
+        {
+            lists.push_back(found);
+        }
+    }
+    return NumList::unionOf(lists);
+}
+
+/**
+ * @brief Find the words that start with a prefix
+ *
+ * Every word with the prefix lives in the prefix's bucket, where the words are sorted byte by byte, so the
+ * matches form one run: from the first word not less than the prefix to the first word not less than the
+ * prefix with its last byte incremented (trailing 0xFF bytes are dropped first; if none remain the run
+ * extends to the end of the bucket).
+ *
+ * @param prefix The characters every match starts with
+ * @param limit The maximum number of matches to return
+ * @return std::vector<const Word*> The matching Words
+ */
+std::vector<const Word*> Dictionary::wordsWithPrefix(std::string_view prefix, size_t limit) const
+{
+    if (prefix.empty())
+    {
+        return wordsInRange(std::string_view(), std::string_view(), limit);
+    }
+
+    std::vector<const Word*> matches;
+    const WordBucket& bucket = wordListBuckets[bucketIndex(prefix)];
+    string upper(prefix);
+    while (!upper.empty() && static_cast<unsigned char>(upper.back()) == 0xFF)
+    {
+        upper.pop_back();
+    }
+    WordBucket::const_iterator last = bucket.end();
+    if (!upper.empty())
+    {
+        upper.back() = static_cast<char>(static_cast<unsigned char>(upper.back()) + 1);
+        last = bucket.seek(upper);
+    }
+    for (auto it = bucket.seek(prefix); it != last && matches.size() < limit; ++it)
+    {
+        matches.push_back(&*it);
+    }
+    return matches;
+}
+
+/**
+ * @brief Find the words from one word up to, but not including, another
+ *
+ * An empty from starts at the first word and an empty to runs to the last word.
+ *
+ * @param from The first word of the range
+ * @param to The word after the range
+ * @param limit The maximum number of matches to return
+ * @return std::vector<const Word*> The matching Words
+ */
+std::vector<const Word*> Dictionary::wordsInRange(std::string_view from, std::string_view to, size_t limit) const
+{
+    std::vector<const Word*> matches;
+    if (!from.empty() && !to.empty() && compareOrder(from, to) >= 0)
+    {
+        return matches;
+    }
+    size_t firstBucket = from.empty() ? 0 : bucketIndex(from);
+    size_t lastBucket = to.empty() ? kBucketCount - 1 : bucketIndex(to);
+    for (size_t index = firstBucket; index <= lastBucket && matches.size() < limit; ++index)
+    {
+        const WordBucket& bucket = wordListBuckets[index];
+        auto it = (index == firstBucket && !from.empty()) ? bucket.seek(from) : bucket.begin();
+        auto last = (index == lastBucket && !to.empty()) ? bucket.seek(to) : bucket.end();
+        for (; it != last && matches.size() < limit; ++it)
+        {
+            matches.push_back(&*it);
+        }
+    }
+    return matches;
+}
+
+/**
+ * @brief Get the most frequent words
+ *
+ * @param k The maximum number of words to return
+ * @return std::vector<const Word*> Up to k Words by descending frequency
+ */
+std::vector<const Word*> Dictionary::topWords(size_t k) const
+{
+    return frequencyIndex.top(k);
+}
+
+/**
+ * @brief Get the number of distinct words in the dictionary
+ *
+ * @return size_t The number of words
+ */
+size_t Dictionary::size() const
+{
+    return wordTable.size();
 }
 
 /**
@@ -66,9 +1006,302 @@ void Dictionary::processWord(const string& word, int linenum)
  * @param out The output stream to which the contents are printed
  */
 void Dictionary::print(ostream& out) const
+{
+    OutputBuffer buffer(out);
+    print(buffer);
+}
+
+/**
+ * @brief Append the contents of the Dictionary to an output buffer
+ *
+ * @param out The buffer to which the contents are appended
+ */
+void Dictionary::print(OutputBuffer& out) const
 {
     for (const auto& wordList : wordListBuckets) // For each bucket in the dictionary
     {
         wordList.print(out); // Print the words in the bucket
     }
 }
+
+/**
+ * @brief Write the Dictionary to a binary snapshot file, in print order
+ *
+ * @param path The name of the snapshot file
+ */
+void Dictionary::save(const string& path) const
+{
+    SnapshotWriter writer(path);
+    for (const auto& wordList : wordListBuckets) // Buckets and the words in them are already in print order
+    {
+        for (const Word& word : wordList)
+        {
+            writer.add(word.view(), word.getFrequency(), word.getNumberList());
+        }
+    }
+    writer.finish();
+}
+
+/**
+ * @brief Sort the postings of every bucket and report each word with its line numbers, in print order
+ *
+ * The buckets are sorted in parallel, then walked in order so that each run of equal words is encoded once.
+ *
+ * @param buckets kBucketCount arrays of postings, each in line order
+ * @param threads The number of threads for sorting, or 0 for one per hardware thread
+ * @param emit Called as emit(word, count, encodedLines) for every distinct word
+ */
+template <typename Emit>
+void Dictionary::emitPostings(std::vector<Posting>* buckets, unsigned threads, Emit emit)
+{
+    parallelFor(threads, kBucketCount, [&](size_t bucket) {
+        std::vector<Posting> buffer(buckets[bucket].size());
+        sortPostings(buckets[bucket].data(), buffer.data(), buckets[bucket].size());
+    });
+    string encoded;
+    for (size_t bucket = 0; bucket < kBucketCount; ++bucket)
+    {
+        const std::vector<Posting>& postings = buckets[bucket];
+        for (size_t first = 0; first < postings.size();)
+        {
+            NumList lines;
+            size_t next = first;
+            for (; next < postings.size() && sameWord(postings[next], postings[first]); ++next)
+            {
+                lines.append(postings[next].line);
+            }
+            encoded.clear();
+            lines.encodeTo(encoded);
+            emit(std::string_view(postings[first].chars, postings[first].length), lines.getSize(), encoded);
+            first = next;
+        }
+    }
+}
+
+/**
+ * @brief Merge a range of sorted runs and report each word with its line numbers, in print order
+ *
+ * A heap holds the current record of every run, ordered by word and then by run, so the records of one
+ * word come out of the heap in the order of their runs. A word held by a single run is passed on as it is;
+ * the line numbers of a word held by several runs are joined in compressed form, where only the first
+ * number of each run has to be encoded again.
+ *
+ * @param runs The runs, in the order their lines appear in the text
+ * @param first The index of the first run to merge
+ * @param last The index past the last run to merge
+ * @param emit Called as emit(word, count, encodedLines) for every distinct word
+ */
+template <typename Emit>
+void Dictionary::mergeRuns(const std::vector<std::unique_ptr<SpillRun>>& runs, size_t first, size_t last, Emit emit)
+{
+    auto later = [&](size_t a, size_t b) {
+        int order = compareOrder(runs[a]->word(), runs[b]->word());
+        return order != 0 ? order > 0 : a > b;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(later)> heap(later);
+    for (size_t index = first; index < last; ++index)
+    {
+        runs[index]->rewind();
+        if (runs[index]->next())
+        {
+            heap.push(index);
+        }
+    }
+
+    string word;
+    string encoded;
+    while (!heap.empty())
+    {
+        size_t index = heap.top();
+        heap.pop();
+        SpillRun& run = *runs[index];
+        if (heap.empty() || runs[heap.top()]->word() != run.word())
+        {
+            emit(run.word(), run.count(), run.encodedLines());
+        }
+        else
+        {
+            // Several runs hold the word: join their line numbers in run order, still encoded
+            word.assign(run.word());
+            NumList lines;
+            lines.compress();
+            NumList part;
+            while (true)
+            {
+                SpillRun& holder = *runs[index];
+                part.assignEncoded(reinterpret_cast<const unsigned char*>(holder.encodedLines().data()),
+                                   static_cast<int>(holder.encodedLines().size()), holder.count());
+                lines.append(part);
+                if (holder.next())
+                {
+                    heap.push(index);
+                }
+                if (heap.empty() || runs[heap.top()]->word() != word)
+                {
+                    break;
+                }
+                index = heap.top();
+                heap.pop();
+            }
+            encoded.clear();
+            lines.encodeTo(encoded);
+            emit(word, lines.getSize(), encoded);
+            continue;
+        }
+        if (run.next())
+        {
+            heap.push(index);
+        }
+    }
+}
+
+/**
+ * @brief Index a text file that may be larger than memory straight into a snapshot file
+ *
+ * The file is read in chunks of whole lines. Postings of the words in the chunks point into the chunks,
+ * which are kept until the postings are sorted. Once the chunks, the postings and room to sort them exceed
+ * the memory budget, the postings are sorted and written as a run, and the memory is released. At the
+ * end the runs are merged k ways into the snapshot; if there are more than SpillRun::kMaxFanIn, groups of
+ * neighbouring runs are first merged into longer runs, which keeps the number of open files bounded.
+ * A file that fits in the budget is never spilled and goes straight from memory to the snapshot.
+ *
+ * @param filename The name of the text file
+ * @param snapshotPath The name of the snapshot file to write
+ * @param options The settings for the build
+ */
+void Dictionary::buildSnapshot(const string& filename, const string& snapshotPath, const DictionaryOptions& options)
+{
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin) // If the file cannot be opened
+    {
+        throw std::runtime_error("could not open input file: " + filename);
+    }
+    SnapshotWriter writer(snapshotPath);
+    string directory = options.spillDirectory.empty() ? std::filesystem::temp_directory_path().string()
+                                                      : options.spillDirectory;
+    size_t chunkSize = std::clamp<size_t>(options.memoryBudget / 16, size_t(64) << 10, size_t(16) << 20);
+
+    std::vector<std::unique_ptr<SpillRun>> runs;
+    std::deque<string> chunks; // A deque never moves its strings, so postings into them stay valid
+    std::vector<Posting> postings[kBucketCount];
+    std::unique_ptr<Arena> scratchArena(new Arena());
+    size_t textBytes = 0;
+    size_t postingCount = 0;
+
+    auto spill = [&]() {
+        std::unique_ptr<SpillRun> run(new SpillRun(directory));
+        emitPostings(postings, options.threads, [&](std::string_view word, int count, std::string_view encoded) {
+            run->add(word, count, encoded);
+        });
+        runs.push_back(std::move(run));
+        for (auto& bucket : postings)
+        {
+            std::vector<Posting>().swap(bucket);
+        }
+        chunks.clear();
+        scratchArena.reset(new Arena());
+        textBytes = 0;
+        postingCount = 0;
+    };
+
+    int linenum = 1;
+    string carry; // The start of a line cut off at the end of the last chunk
+    while (fin)
+    {
+        string chunk = std::move(carry);
+        carry.clear();
+        size_t start = chunk.size();
+        chunk.resize(start + chunkSize);
+        fin.read(&chunk[start], chunkSize);
+        chunk.resize(start + fin.gcount());
+        if (fin) // More to come: hold back the last, possibly partial, line
+        {
+            size_t cut = chunk.rfind('\n');
+            if (cut == string::npos) // A line longer than a chunk: keep reading it
+            {
+                carry = std::move(chunk);
+                continue;
+            }
+            carry.assign(chunk, cut + 1, string::npos);
+            chunk.resize(cut + 1);
+        }
+        chunks.push_back(std::move(chunk));
+        linenum = collectPostings(chunks.back(), linenum, options.normalization, postings, *scratchArena);
+        textBytes += chunks.back().size();
+        postingCount = 0;
+        size_t postingBytes = 0;
+        for (const auto& bucket : postings)
+        {
+            postingCount += bucket.size();
+            postingBytes += (bucket.capacity() + bucket.size()) * sizeof(Posting); // Plus the buffer to sort through
+        }
+        if (textBytes + scratchArena->bytesUsed() + postingBytes >= options.memoryBudget)
+        {
+            spill();
+        }
+    }
+
+    auto write = [&](std::string_view word, int count, std::string_view encoded) {
+        writer.add(word, count, count, encoded);
+    };
+    if (runs.empty())
+    {
+        emitPostings(postings, options.threads, write);
+    }
+    else
+    {
+        if (postingCount != 0)
+        {
+            spill();
+        }
+        while (runs.size() > SpillRun::kMaxFanIn)
+        {
+            std::vector<std::unique_ptr<SpillRun>> merged;
+            for (size_t first = 0; first < runs.size(); first += SpillRun::kMaxFanIn)
+            {
+                size_t last = std::min(first + SpillRun::kMaxFanIn, runs.size());
+                std::unique_ptr<SpillRun> run(new SpillRun(directory));
+                mergeRuns(runs, first, last, [&](std::string_view word, int count, std::string_view encoded) {
+                    run->add(word, count, encoded);
+                });
+                merged.push_back(std::move(run));
+                for (size_t index = first; index < last; ++index)
+                {
+                    runs[index].reset(); // Remove each input file as soon as it is merged
+                }
+            }
+            runs = std::move(merged);
+        }
+        mergeRuns(runs, 0, runs.size(), write);
+    }
+    writer.finish();
+}
+
+/**
+ * @brief Get one of the buckets
+ *
+ * @param index The index of the bucket, less than kBucketCount
+ * @return const WordBucket& A constant reference to the bucket
+ */
+const WordBucket& Dictionary::getBucket(size_t index) const
+{
+    return wordListBuckets[index];
+}
+
+/**
+ * @brief Compare two words in the order the Dictionary prints them
+ *
+ * @param a The first word
+ * @param b The second word
+ * @return int Negative if a comes first, 0 if equal, positive if b comes first
+ */
+int Dictionary::compareOrder(std::string_view a, std::string_view b)
+{
+    size_t bucketA = bucketIndex(a);
+    size_t bucketB = bucketIndex(b);
+    if (bucketA != bucketB)
+    {
+        return bucketA < bucketB ? -1 : 1;
+    }
+    return a.compare(b); // Byte order, the same as strcmp within a bucket
+}
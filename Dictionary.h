@@ -2,11 +2,66 @@
 #define DICTIONARY_H_
 
 #include<string>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+#include "Arena.h"
+#include "FrequencyIndex.h"
+#include "Normalizer.h"
+#include "WordBucket.h"
 #include "WordList.h"
+#include "WordTable.h"
 
 using std::string;
 using std::ostream;
 
+class SpillRun;
+
+/**
+ * How the Dictionary constructor reads its input file.
+ */
+enum class IngestMode {
+    /** Read the file line by line with getline and split each line with the Tokenizer */
+    Stream,
+    /** Map the file into memory and tokenize the mapped bytes in place, copying only new words */
+    Mapped,
+    /** Map the file, build one private shard per thread from a slice of whole lines, then merge the shards */
+    Parallel,
+    /** Map the file, collect every (word, line) pair into flat arrays, sort them in parallel, then build each bucket in one pass */
+    Bulk
+};
+
+/**
+ * Settings for building a Dictionary from a file.
+ */
+struct DictionaryOptions {
+    /** How the input file is read */
+    IngestMode mode = IngestMode::Stream;
+
+    /** The number of threads for IngestMode::Parallel and IngestMode::Bulk, or 0 for one per hardware thread */
+    unsigned threads = 0;
+
+    /** Store the line numbers of every word delta + varint compressed (see NumList::compress) */
+    bool compressPostings = false;
+
+    /** How tokens are turned into stored words, e.g. Normalization::CaseFold | Normalization::StripPunctuation */
+    Normalization normalization = Normalization::Verbatim;
+
+    /** The number of leading bytes, 1 to 3, that split a bucket into partitions (see WordBucket) */
+    unsigned bucketPrefixBytes = WordBucket::kMaxPrefixBytes;
+
+    /** The number of words a bucket partition may hold before it is split, or 0 to keep one list per bucket */
+    size_t bucketSplitThreshold = WordBucket::kDefaultSplitThreshold;
+
+    /** For Dictionary::buildSnapshot, the bytes of text and postings held before a sorted run is spilled to disk */
+    size_t memoryBudget = size_t(256) << 20;
+
+    /** For Dictionary::buildSnapshot, the directory runs are spilled to, or empty for the system temporary directory */
+    string spillDirectory;
+};
+
 /**
  * The Dictionary class processes and stores words in WordList buckets.
  * It provides methods for adding words to the dictionary, printing its contents, and managing word buckets.
@@ -16,53 +71,430 @@ private:
     /** The name of the file the dictionary words are read from */
     string filename;
 
-    /** An array of WordList buckets for storing words. 26 alpha buckets + 1 none-alpha bucket */
-    WordList wordListBuckets[27];
+    /**
+     * Arena holding the nodes and characters of every Word in the buckets, released in one go with the Dictionary.
+     * Declared before the buckets so it outlives them.
+     */
+    std::unique_ptr<Arena> arena{ new Arena() };
+
+public:
+    /** The number of buckets: 26 alpha buckets + 1 none-alpha bucket */
+    static constexpr size_t kBucketCount = 27;
+
+private:
+    /**
+     * An array of buckets for storing words. 26 alpha buckets + 1 none-alpha bucket.
+     * Each bucket is further split into partitions by the leading bytes of its words.
+     */
+    WordBucket wordListBuckets[kBucketCount];
+
+    /** Whether new words get their line numbers stored compressed */
+    bool compressPostings{ false };
+
+    /** The steps every token goes through before it is stored */
+    Normalization normalization{ Normalization::Verbatim };
+
+    /** Hash index over every Word in the buckets, so repeated words are found without searching a bucket */
+    WordTable wordTable;
+
+    /** Every Word in the buckets ordered by frequency, updated as words are seen; ids are kept in wordTable */
+    FrequencyIndex frequencyIndex;
+
+    /** The start of a word cut off at the end of the last chunk passed to ingest */
+    string pendingWord;
+
+    /** The line number the next chunk passed to ingest starts on */
+    int ingestLine{ 1 };
 
     /**
-     * Calculate the bucket index for a given word.
-     * @param word The word to calculate the bucket index for.
-     * @return The index of the bucket where the word should be stored.
+     * Rebuild the hash index and the frequency index from the contents of the buckets.
+     */
+    void reindex();
+
+    /**
+     * Split a block of text on whitespace and process every word in it.
+     * @param text The text to process. Lines are separated by '\n'.
+     * @param linenum The line number of the first line in text.
+     * @return The line number the text following this block would start on.
+     */
+    int processText(std::string_view text, int linenum);
+
+    /**
+     * Add an already normalized word to the correct WordList bucket.
+     * @param word The word to be added.
+     * @param linenum The line number where the word was found.
      */
-    size_t bucketIndex(const string& word) const;
+    void addWord(std::string_view word, int linenum);
+
+    /**
+     * Build the dictionary from a mapped file using one shard per thread.
+     * @param text The contents of the file.
+     * @param threads The number of threads to use, or 0 for one per hardware thread.
+     */
+    void buildParallel(std::string_view text, unsigned threads);
+
+    /**
+     * One occurrence of a word, as collected by a bulk build.
+     */
+    struct Posting {
+        /** The first eight characters as a big-endian number (see Word::prefixOf) */
+        uint64_t prefix;
+
+        /** The characters of the word; they live in the input text or in a scratch Arena */
+        const char* chars;
+
+        /** The number of characters */
+        uint32_t length;
+
+        /** The line the word was found on */
+        int line;
+    };
+
+    /**
+     * Orders postings by word, in the same order as Word::compare, and then by line.
+     * @param a The first posting.
+     * @param b The second posting.
+     * @return true if a sorts before b.
+     */
+    static bool postingBefore(const Posting& a, const Posting& b);
+
+    /**
+     * Checks whether two postings are occurrences of the same word.
+     * @param a The first posting.
+     * @param b The second posting.
+     * @return true if both postings have the same characters.
+     */
+    static bool sameWord(const Posting& a, const Posting& b);
+
+    /**
+     * Tokenize and normalize a block of text into postings, split by bucket.
+     * @param text The text to tokenize; the postings point into it. Lines are separated by '\n'.
+     * @param linenum The line number of the first line in text.
+     * @param normalization The steps every token goes through.
+     * @param buckets kBucketCount arrays the postings are appended to.
+     * @param scratchArena Storage for words that normalization rewrote.
+     * @return The line number the text following this block would start on.
+     */
+    static int collectPostings(std::string_view text, int linenum, Normalization normalization,
+                               std::vector<Posting>* buckets, Arena& scratchArena);
+
+    /**
+     * Sort postings by word with a stable most-significant-byte radix sort on their prefixes.
+     * Postings of the same word keep their relative order, so lines collected in order stay in order.
+     * @param postings The postings to sort.
+     * @param buffer Scratch space for at least count postings.
+     * @param count The number of postings.
+     * @param byte The index of the prefix byte to sort on; the bytes before it are equal in all postings.
+     */
+    static void sortPostings(Posting* postings, Posting* buffer, size_t count, unsigned byte = 0);
+
+    /**
+     * Cut a text into slices of whole lines and number the first line of each.
+     * @param text The text to cut.
+     * @param sliceCount The number of slices wanted.
+     * @param threads The number of threads for counting lines, or 0 for one per hardware thread.
+     * @param firstLine Receives the number of the first line of every slice, plus one entry past the last slice.
+     * @return The slices, each ending just after a line break except the last one.
+     */
+    static std::vector<std::string_view> sliceLines(std::string_view text, size_t sliceCount, unsigned threads,
+                                                    std::vector<int>& firstLine);
+
+    /**
+     * Sort the postings of every bucket and report each word with its line numbers, in print order.
+     * @param buckets kBucketCount arrays of postings, each in line order; they are sorted in place.
+     * @param threads The number of threads for sorting, or 0 for one per hardware thread.
+     * @param emit Called as emit(word, count, encodedLines) for every distinct word, with the line numbers
+     * delta + varint encoded as in NumList::compress.
+     */
+    template <typename Emit>
+    static void emitPostings(std::vector<Posting>* buckets, unsigned threads, Emit emit);
+
+    /**
+     * Merge a range of sorted runs and report each word with its line numbers, in print order.
+     * A word found in several runs gets the line numbers of the earlier run first.
+     * @param runs The runs, in the order their lines appear in the text.
+     * @param first The index of the first run to merge.
+     * @param last The index past the last run to merge.
+     * @param emit Called as emit(word, count, encodedLines) for every distinct word.
+     */
+    template <typename Emit>
+    static void mergeRuns(const std::vector<std::unique_ptr<SpillRun>>& runs, size_t first, size_t last, Emit emit);
+
+    /**
+     * Build the dictionary from a mapped file by sorting all of its postings at once.
+     * @param text The contents of the file.
+     * @param threads The number of threads to use, or 0 for one per hardware thread.
+     */
+    void buildBulk(std::string_view text, unsigned threads);
+
+    /**
+     * Point every bucket at this Dictionary's arena.
+     */
+    void attachArena();
+
+    /**
+     * Set how every bucket is split into partitions.
+     * @param options The partitioning settings.
+     */
+    void configureBuckets(const DictionaryOptions& options);
 
 public:
+    /**
+     * Creates an empty Dictionary that is not tied to a file. Words are added with ingest or processWord.
+     */
+    Dictionary();
+
+    /**
+     * Creates an empty Dictionary that stores words with the given settings. The ingest settings are ignored.
+     * @param options How the words are stored.
+     */
+    explicit Dictionary(const DictionaryOptions& options);
+
     /**
      * Constructor that takes a filename and creates a Dictionary.
      * @param filename The name of the file to read words from.
+     * @param mode How the file is read (default is line by line through an input stream).
+     * @param threads The number of threads for IngestMode::Parallel and IngestMode::Bulk, or 0 for one per hardware thread.
+     * @throws std::runtime_error If the file cannot be opened.
+     */
+    Dictionary(const string& filename, IngestMode mode = IngestMode::Stream, unsigned threads = 0);
+
+    /**
+     * Constructor that takes a filename and the settings to build the Dictionary with.
+     * @param filename The name of the file to read words from.
+     * @param options How the file is read and how the words are stored.
+     * @throws std::runtime_error If the file cannot be opened.
+     */
+    Dictionary(const string& filename, const DictionaryOptions& options);
+
+    /**
+     * Adds the words of the next chunk of a text that arrives piece by piece, such as a pipe or a growing log.
+     * A chunk may end in the middle of a word or a line; the cut-off word is kept and completed by the next
+     * chunk, and line numbers continue across calls. Between calls the Dictionary holds exactly the complete
+     * words seen so far, so it can be printed or queried at any time.
+     * @param chunk The next piece of the text.
+     */
+    void ingest(std::string_view chunk);
+
+    /**
+     * Adds the words of everything left in an input stream, reading it in large chunks (see ingest).
+     * @param in The input stream to read until end of file.
+     */
+    void ingest(std::istream& in);
+
+    /**
+     * Ends the current text: adds the word cut off at the end of the last chunk, if any.
+     * Chunks passed to ingest afterwards continue the line numbering.
+     */
+    void finish();
+
+    /**
+     * Re-lays the words out in print order in fresh memory, so that printing, saving and range scans stream
+     * through memory instead of visiting nodes in the order they were allocated. Takes time linear in the
+     * number of words. Pointers returned by find and the other queries are invalidated.
+     */
+    void compact();
+
+    /**
+     * Merges the words of another Dictionary into this one, e.g. one built by another process from the next file.
+     * Words found in both get the other Word's line numbers, plus lineOffset, appended after their own; words only
+     * the other Dictionary holds are copied. Each bucket is merged in one linear pass, and different buckets are
+     * merged in parallel. Words are merged as they are stored, so both should use the same normalization.
+     * Copied line numbers are stored compressed or not as this Dictionary's compressPostings setting says.
+     * Both Dictionaries are taken as finished: a word held back by an unfinished ingest is added as a whole word.
+     * Pointers returned by find and the other queries are invalidated.
+     * @param other The Dictionary to merge in; it is left as it is.
+     * @param lineOffset The amount added to each line number taken from other, such as the number of lines
+     * this Dictionary was built from.
+     * @param threads The number of threads to use, or 0 for one per hardware thread (default is 0).
      */
-    Dictionary(const string& filename);
+    void merge(const Dictionary& other, int lineOffset, unsigned threads = 0);
 
     /**
      * Process a word from the file and add it to the correct WordList bucket.
+     * The word is normalized first (see DictionaryOptions::normalization); if nothing is left of it, it is dropped.
+     * Words already in the dictionary are found through the hash index and only get the line number appended.
      * @param word The word to be processed.
      * @param linenum The line number where the word was found.
+     * @return The index of the bucket the normalized word went to, or kBucketCount if the word was dropped.
+     */
+    size_t processWord(std::string_view word, int linenum);
+
+    /**
+     * Normalizes a word the way the words of this Dictionary were. Lookups compare against the stored words,
+     * so a query such as "The," only finds "the" after going through this.
+     * @param word The word to normalize.
+     * @return The normalized word; empty if nothing is left of it.
+     */
+    std::string normalize(std::string_view word) const;
+
+    /**
+     * Looks a word up through the hash index in expected O(1) time.
+     * @param word The characters of the word.
+     * @return A pointer to the Word, or nullptr if the word is not in the dictionary.
+     *         It stays valid until the Dictionary is modified through copy or move assignment or destroyed.
+     */
+    const Word* find(std::string_view word) const;
+
+    /**
+     * Looks up many words at once. The batch is worked through in groups whose hash slots, Words and characters
+     * are prefetched one step at a time, so the cache misses of a group overlap instead of being paid one by one.
+     * @param words The words to look up.
+     * @param count The number of words.
+     * @param results Receives, for every word, a pointer to its Word or nullptr (as find would return).
+     */
+    void findBatch(const std::string_view* words, size_t count, const Word** results) const;
+
+    /**
+     * Looks up many words at once (see findBatch(const std::string_view*, size_t, const Word**)).
+     * @param words The words to look up.
+     * @return For every word, a pointer to its Word or nullptr.
+     */
+    std::vector<const Word*> findBatch(const std::vector<std::string_view>& words) const;
+
+    /**
+     * Returns the number of occurrences of a word.
+     * @param word The characters of the word.
+     * @return The frequency of the word, or 0 if it is not in the dictionary.
+     */
+    int frequency(std::string_view word) const;
+
+    /**
+     * Returns the line numbers of a word without copying them.
+     * The list can be iterated, indexed or copied out with NumList::copyTo, in plain or compressed mode alike.
+     * @param word The characters of the word.
+     * @return A pointer to the word's line numbers, or nullptr if the word is not in the dictionary.
+     *         It stays valid as long as the pointer returned by find would.
+     */
+    const NumList* lines(std::string_view word) const;
+
+    /**
+     * Finds the lines on which every one of several words occurs (see NumList::intersectionOf).
+     * @param words The words.
+     * @return The line numbers, in increasing order without repeats; empty if any word is not in the dictionary.
      */
-    void processWord(const string& word, int linenum);
+    NumList linesWithAll(const std::vector<std::string_view>& words) const;
+
+    /**
+     * Finds the lines on which at least one of several words occurs (see NumList::unionOf).
+     * @param words The words. Words that are not in the dictionary are ignored.
+     * @return The line numbers, in increasing order without repeats.
+     */
+    NumList linesWithAny(const std::vector<std::string_view>& words) const;
+
+    /**
+     * Finds the words that start with a prefix, in the order print lists them.
+     * The start and end of the matches are found by skip-list seeks in the prefix's bucket, so the cost is
+     * O(log n) plus the number of matches returned.
+     * @param prefix The characters every match starts with. An empty prefix matches every word.
+     * @param limit The maximum number of matches to return (default is all of them).
+     * @return The matching Words, each giving access to its characters, frequency and line numbers.
+     */
+    std::vector<const Word*> wordsWithPrefix(std::string_view prefix, size_t limit = SIZE_MAX) const;
+
+    /**
+     * Finds the words from one word up to, but not including, another, in the order print lists them
+     * (see compareOrder). Both ends are found by O(log n) seeks; the buckets in between are walked in full.
+     * @param from The first word of the range, or the position where it would be.
+     * @param to The word after the range, or the position where it would be.
+     * @param limit The maximum number of matches to return (default is all of them).
+     * @return The matching Words, each giving access to its characters, frequency and line numbers.
+     */
+    std::vector<const Word*> wordsInRange(std::string_view from, std::string_view to, size_t limit = SIZE_MAX) const;
+
+    /**
+     * Returns the most frequent words in O(k), from an order that is maintained as words are added.
+     * @param k The maximum number of words to return.
+     * @return Up to k Words by descending frequency; words with equal frequency come in no particular order.
+     */
+    std::vector<const Word*> topWords(size_t k) const;
+
+    /**
+     * Returns the number of distinct words in the dictionary.
+     * @return The number of words.
+     */
+    size_t size() const;
 
     /**
      * Prints the contents of the Dictionary to an output stream.
+     * The text is formatted into a large buffer and written out in big chunks (see OutputBuffer).
      * @param out The output stream to print to.
      */
     void print(ostream& out) const;
 
-    // Deleting the default constructor as it is not required.
-    Dictionary()  = delete;
+    /**
+     * Appends the contents of the Dictionary to an output buffer, in the same format as print(ostream&).
+     * @param out The buffer to append to.
+     */
+    void print(OutputBuffer& out) const;
+
+    /**
+     * Writes the Dictionary to a binary snapshot file that DictionarySnapshot can map and query without rebuilding.
+     * @param path The name of the snapshot file.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    void save(const string& path) const;
+
+    /**
+     * Indexes a text file that may be larger than memory straight into a snapshot file (see save and
+     * DictionarySnapshot), without building a Dictionary. Sorted runs of at most options.memoryBudget bytes
+     * are spilled to temporary files in options.spillDirectory and merged k ways into the snapshot.
+     * The normalization and threads options apply as for IngestMode::Bulk; the other ones are ignored.
+     * @param filename The name of the text file.
+     * @param snapshotPath The name of the snapshot file to write.
+     * @param options The settings for the build.
+     * @throws std::runtime_error If a file cannot be opened, created or written.
+     */
+    static void buildSnapshot(const string& filename, const string& snapshotPath,
+                              const DictionaryOptions& options = DictionaryOptions());
+
+    /**
+     * Calculate the bucket index for a given word.
+     * @param word The word to calculate the bucket index for.
+     * @return The index of the bucket where the word should be stored.
+     */
+    static size_t bucketIndex(std::string_view word);
+
+    /**
+     * Returns one of the buckets, in which the words are kept sorted.
+     * @param index The index of the bucket, less than kBucketCount.
+     * @return A constant reference to the bucket.
+     */
+    const WordBucket& getBucket(size_t index) const;
+
+    /**
+     * Compares two words in the order print lists them: by bucket (letter, then everything else), then byte by byte.
+     * @param a The first word.
+     * @param b The second word.
+     * @return A negative value if a comes first, 0 if the words are equal, a positive value if b comes first.
+     */
+    static int compareOrder(std::string_view a, std::string_view b);
 
     // Using the default destructor.
     ~Dictionary() = default;
 
-    // Using the default copy constructor.
-    Dictionary(const Dictionary& ) = default;
+    /**
+     * Copy constructor. Copies the buckets and rebuilds the hash index over the copies.
+     * @param other The Dictionary to copy.
+     */
+    Dictionary(const Dictionary& other);
 
     // Using the default move constructor.
     Dictionary(Dictionary&&) = default;
 
-    // Using the default copy assignment operator.
-    Dictionary& operator=(const Dictionary&) = default;
+    /**
+     * Copy assignment operator. Copies the buckets and rebuilds the hash index over the copies.
+     * @param other The Dictionary to copy.
+     * @return A reference to the updated Dictionary.
+     */
+    Dictionary& operator=(const Dictionary& other);
 
-    // Using the default move assignment operator.
-    Dictionary& operator=(Dictionary&&) = default;
+    /**
+     * Move assignment operator. The buckets are replaced before the old arena is released.
+     * @param other The Dictionary to move from.
+     * @return A reference to the updated Dictionary.
+     */
+    Dictionary& operator=(Dictionary&& other);
 };
 
 #endif /* DICTIONARY_H_ */
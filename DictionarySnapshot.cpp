@@ -0,0 +1,159 @@
+#include <cstring>
+#include <stdexcept>
+#include "DictionarySnapshot.h"
+#include "Dictionary.h"
+#include "OutputBuffer.h"
+#include "SnapshotWriter.h"
+
+/**
+ * Constructor that maps a snapshot file and checks its header.
+ * @param path The name of the snapshot file.
+ * @throws std::runtime_error If the file cannot be opened or is not a snapshot written on this platform.
+ */
+DictionarySnapshot::DictionarySnapshot(const std::string& path) : file(path) {
+    if (!file) {
+        throw std::runtime_error("could not open snapshot file: " + path);
+    }
+    SnapshotWriter::Header header;
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error("not a dictionary snapshot: " + path);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, SnapshotWriter::kMagic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("not a dictionary snapshot: " + path);
+    }
+    if (header.byteOrder != SnapshotWriter::kByteOrderMark || header.version != SnapshotWriter::kVersion) {
+        throw std::runtime_error("unsupported dictionary snapshot format: " + path);
+    }
+    if (header.indexOffset > file.size() || header.wordCount > (file.size() - header.indexOffset) / sizeof(uint64_t)) {
+        throw std::runtime_error("truncated dictionary snapshot: " + path);
+    }
+    wordCount = static_cast<size_t>(header.wordCount);
+    indexOffset = header.indexOffset;
+}
+
+/**
+ * Returns the number of words in the snapshot.
+ * @return The number of words.
+ */
+size_t DictionarySnapshot::size() const {
+    return wordCount;
+}
+
+/**
+ * Checks whether a word is in the snapshot.
+ * @param word The word to look for.
+ * @return true if the word is in the snapshot, false otherwise.
+ */
+bool DictionarySnapshot::contains(std::string_view word) const {
+    Record found;
+    return locate(word, found);
+}
+
+/**
+ * Returns the number of occurrences of a word.
+ * @param word The word to look for.
+ * @return The frequency of the word, or 0 if it is not in the snapshot.
+ */
+int DictionarySnapshot::frequency(std::string_view word) const {
+    Record found;
+    return locate(word, found) ? found.frequency : 0;
+}
+
+/**
+ * Decodes the line numbers of a word.
+ * @param word The word to look for.
+ * @param out Receives the line numbers (in compressed mode) if the word is in the snapshot.
+ * @return true if the word is in the snapshot, false otherwise.
+ */
+bool DictionarySnapshot::lines(std::string_view word, NumList& out) const {
+    Record found;
+    if (!locate(word, found)) {
+        return false;
+    }
+    out.assignEncoded(reinterpret_cast<const unsigned char*>(found.encodedLines.data()),
+                      static_cast<int>(found.encodedLines.size()), found.count);
+    return true;
+}
+
+/**
+ * Returns the word with a given position in the order Dictionary::print lists them.
+ * @param position The position of the word, less than size().
+ * @return A view of the word's characters inside the mapping.
+ */
+std::string_view DictionarySnapshot::wordAt(size_t position) const {
+    return record(position).word;
+}
+
+/**
+ * Prints every word in the same format as Dictionary::print.
+ * @param out The output stream to print to.
+ */
+void DictionarySnapshot::print(std::ostream& out) const {
+    OutputBuffer buffer(out);
+    NumList numbers;
+    for (size_t i = 0; i < wordCount; ++i) {
+        Record current = record(i);
+        numbers.assignEncoded(reinterpret_cast<const unsigned char*>(current.encodedLines.data()),
+                              static_cast<int>(current.encodedLines.size()), current.count);
+        buffer.append(current.word);
+        buffer.append(": ");
+        buffer.append(current.frequency);
+        buffer.append(" times, lines: ");
+        numbers.print(buffer);
+        buffer.append('\n');
+    }
+}
+
+/**
+ * Reads the record with a given position in word order.
+ * @param position The position of the record, less than size().
+ * @return The record.
+ * @throws std::runtime_error If the record lies outside the file.
+ */
+DictionarySnapshot::Record DictionarySnapshot::record(size_t position) const {
+    uint64_t offset;
+    std::memcpy(&offset, file.data() + indexOffset + position * sizeof(uint64_t), sizeof(offset));
+    SnapshotWriter::RecordHeader header;
+    if (offset > indexOffset || indexOffset - offset < sizeof(header)) {
+        throw std::runtime_error("corrupt dictionary snapshot");
+    }
+    std::memcpy(&header, file.data() + offset, sizeof(header));
+    uint64_t payload = uint64_t(header.length) + header.encodedBytes;
+    if (payload > indexOffset - offset - sizeof(header)) {
+        throw std::runtime_error("corrupt dictionary snapshot");
+    }
+    const char* wordStart = file.data() + offset + sizeof(header);
+    Record result;
+    result.word = std::string_view(wordStart, header.length);
+    result.frequency = static_cast<int>(header.frequency);
+    result.count = static_cast<int>(header.count);
+    result.encodedLines = std::string_view(wordStart + header.length, header.encodedBytes);
+    return result;
+}
+
+/**
+ * Binary-searches the record index for a word, comparing in Dictionary::compareOrder order.
+ * @param word The word to look for.
+ * @param found Receives the record if the word is in the snapshot.
+ * @return true if the word is in the snapshot, false otherwise.
+ */
+bool DictionarySnapshot::locate(std::string_view word, Record& found) const {
+    size_t low = 0;
+    size_t high = wordCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        Record candidate = record(middle);
+        int order = Dictionary::compareOrder(candidate.word, word);
+        if (order == 0) {
+            found = candidate;
+            return true;
+        }
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return false;
+}
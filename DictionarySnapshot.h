@@ -0,0 +1,103 @@
+#ifndef DICTIONARYSNAPSHOT_H_
+#define DICTIONARYSNAPSHOT_H_
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "MappedFile.h"
+#include "NumList.h"
+
+/**
+ * The DictionarySnapshot class gives read-only access to a snapshot file written by Dictionary::save.
+ * The file is memory-mapped and nothing is deserialized up front: a lookup binary-searches the record index
+ * in the mapping and only decodes the line numbers that are asked for.
+ */
+class DictionarySnapshot {
+private:
+    /**
+     * A record of the snapshot, pointing into the mapping.
+     */
+    struct Record {
+        std::string_view word;
+        int frequency;
+        int count;
+        std::string_view encodedLines;
+    };
+
+    /** The mapped snapshot file */
+    MappedFile file;
+
+    /** The number of words in the snapshot */
+    size_t wordCount{ 0 };
+
+    /** Offset of the record index in the file */
+    uint64_t indexOffset{ 0 };
+
+    /**
+     * Reads the record with a given position in word order.
+     * @param position The position of the record, less than size().
+     * @return The record.
+     * @throws std::runtime_error If the record lies outside the file.
+     */
+    Record record(size_t position) const;
+
+    /**
+     * Binary-searches the record index for a word.
+     * @param word The word to look for.
+     * @param found Receives the record if the word is in the snapshot.
+     * @return true if the word is in the snapshot, false otherwise.
+     */
+    bool locate(std::string_view word, Record& found) const;
+
+public:
+    /**
+     * Constructor that maps a snapshot file and checks its header.
+     * @param path The name of the snapshot file.
+     * @throws std::runtime_error If the file cannot be opened or is not a snapshot written on this platform.
+     */
+    explicit DictionarySnapshot(const std::string& path);
+
+    /**
+     * Returns the number of words in the snapshot.
+     * @return The number of words.
+     */
+    size_t size() const;
+
+    /**
+     * Checks whether a word is in the snapshot.
+     * @param word The word to look for.
+     * @return true if the word is in the snapshot, false otherwise.
+     */
+    bool contains(std::string_view word) const;
+
+    /**
+     * Returns the number of occurrences of a word.
+     * @param word The word to look for.
+     * @return The frequency of the word, or 0 if it is not in the snapshot.
+     */
+    int frequency(std::string_view word) const;
+
+    /**
+     * Decodes the line numbers of a word.
+     * @param word The word to look for.
+     * @param out Receives the line numbers (in compressed mode) if the word is in the snapshot.
+     * @return true if the word is in the snapshot, false otherwise.
+     */
+    bool lines(std::string_view word, NumList& out) const;
+
+    /**
+     * Returns the word with a given position in the order Dictionary::print lists them.
+     * @param position The position of the word, less than size().
+     * @return A view of the word's characters inside the mapping.
+     */
+    std::string_view wordAt(size_t position) const;
+
+    /**
+     * Prints every word in the same format as Dictionary::print.
+     * @param out The output stream to print to.
+     */
+    void print(std::ostream& out) const;
+};
+
+#endif /* DICTIONARYSNAPSHOT_H_ */
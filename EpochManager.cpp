@@ -0,0 +1,99 @@
+#include <functional>
+#include <thread>
+#include "EpochManager.h"
+
+/**
+ * Constructor that enters a critical section.
+ * The slot's epoch is stored before anything shared is read, so a writer that unpublishes an object after
+ * this point either sees the reader's epoch when it reclaims, or the reader sees the new object instead.
+ * @param manager The EpochManager to register with.
+ */
+EpochManager::Guard::Guard(EpochManager& manager) : manager(&manager), slot(manager.acquireSlot()) {
+    manager.slots[slot].epoch.store(manager.globalEpoch.load());
+}
+
+/**
+ * Destructor. Leaves the critical section.
+ */
+EpochManager::Guard::~Guard() {
+    if (manager != nullptr) {
+        manager->slots[slot].epoch.store(kIdle, std::memory_order_release);
+        manager->slots[slot].taken.store(false, std::memory_order_release);
+    }
+}
+
+/**
+ * Move constructor. The other Guard no longer protects anything.
+ * @param other The Guard to move from.
+ */
+EpochManager::Guard::Guard(Guard&& other) noexcept : manager(other.manager), slot(other.slot) {
+    other.manager = nullptr;
+}
+
+/**
+ * Constructor that creates a manager with no retired objects.
+ */
+EpochManager::EpochManager() = default;
+
+/**
+ * Destructor. Deletes every retired object; no Guard may still exist.
+ */
+EpochManager::~EpochManager() {
+    for (Retired& item : retired) {
+        item.deleter(item.object);
+    }
+}
+
+/**
+ * Claims a free reader slot, starting the search at a position derived from the calling thread.
+ * @return The index of the claimed slot.
+ */
+size_t EpochManager::acquireSlot() {
+    size_t start = std::hash<std::thread::id>()(std::this_thread::get_id());
+    for (size_t i = 0;; ++i) {
+        size_t index = (start + i) % kMaxReaders;
+        Slot& candidate = slots[index];
+        if (!candidate.taken.load(std::memory_order_relaxed) &&
+            !candidate.taken.exchange(true, std::memory_order_acquire)) {
+            return index;
+        }
+        if (i % kMaxReaders == kMaxReaders - 1) {
+            std::this_thread::yield(); // More than kMaxReaders readers at once: wait for one to leave
+        }
+    }
+}
+
+/**
+ * Hands an object that is no longer reachable for new readers over for deferred deletion.
+ * @param object The object to delete later.
+ * @param deleter The function that deletes it.
+ */
+void EpochManager::retire(void* object, void (*deleter)(void*)) {
+    retired.push_back(Retired{ globalEpoch.fetch_add(1), object, deleter });
+}
+
+/**
+ * Deletes every retired object that no reader can still be using.
+ * A reader that entered in epoch e may hold objects retired with a tag of e or later, so objects tagged
+ * below the oldest epoch in use are safe.
+ * @return The number of objects still waiting for readers to finish.
+ */
+size_t EpochManager::reclaim() {
+    uint64_t oldest = kIdle;
+    for (const Slot& reader : slots) {
+        uint64_t epoch = reader.epoch.load();
+        if (epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+    size_t kept = 0;
+    for (Retired& item : retired) {
+        if (item.epoch < oldest) {
+            item.deleter(item.object);
+        } else {
+            retired[kept++] = item;
+        }
+    }
+    retired.resize(kept);
+    return kept;
+}
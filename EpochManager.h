@@ -0,0 +1,124 @@
+#ifndef EPOCHMANAGER_H_
+#define EPOCHMANAGER_H_
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * The EpochManager class implements epoch-based reclamation: writers retire objects that readers may still be
+ * looking at, and the objects are only deleted once every reader that could have seen them has finished.
+ *
+ * A reader enters a critical section by taking a Guard, which records the current global epoch in a reader slot.
+ * A writer that has unpublished an object retires it tagged with the current epoch and advances the epoch.
+ * The object is deleted by a later reclaim() once no reader slot holds an epoch at or below its tag.
+ * Readers never wait for writers and never write shared state other than their own slot.
+ * Retiring and reclaiming are not thread-safe with respect to each other; callers serialize their writers.
+ */
+class EpochManager {
+public:
+    /** Maximum number of readers inside a critical section at the same time */
+    static constexpr size_t kMaxReaders = 128;
+
+    /**
+     * RAII reader critical section. Objects that were reachable when the Guard was taken stay alive until it is
+     * destroyed. Guards must not outlive their EpochManager.
+     */
+    class Guard {
+    private:
+        /** The manager the slot belongs to, or nullptr for a moved-from Guard */
+        EpochManager* manager;
+
+        /** The reader slot held by this Guard */
+        size_t slot;
+
+    public:
+        /**
+         * Constructor that enters a critical section.
+         * @param manager The EpochManager to register with.
+         */
+        explicit Guard(EpochManager& manager);
+
+        /**
+         * Destructor. Leaves the critical section.
+         */
+        ~Guard();
+
+        /**
+         * Move constructor. The other Guard no longer protects anything.
+         * @param other The Guard to move from.
+         */
+        Guard(Guard&& other) noexcept;
+
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        Guard& operator=(Guard&&) = delete;
+    };
+
+    /**
+     * Constructor that creates a manager with no retired objects.
+     */
+    EpochManager();
+
+    /**
+     * Destructor. Deletes every retired object; no Guard may still exist.
+     */
+    ~EpochManager();
+
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    /**
+     * Hands an object that is no longer reachable for new readers over for deferred deletion.
+     * @param object The object to delete later.
+     * @param deleter The function that deletes it.
+     */
+    void retire(void* object, void (*deleter)(void*));
+
+    /**
+     * Deletes every retired object that no reader can still be using.
+     * @return The number of objects still waiting for readers to finish.
+     */
+    size_t reclaim();
+
+private:
+    /** Slot value of a reader that is not in a critical section */
+    static constexpr uint64_t kIdle = UINT64_MAX;
+
+    /**
+     * A reader slot, padded to a cache line of its own so readers do not contend.
+     */
+    struct alignas(64) Slot {
+        /** Whether a Guard owns the slot */
+        std::atomic<bool> taken{ false };
+
+        /** The epoch the owning reader entered in, or kIdle */
+        std::atomic<uint64_t> epoch{ kIdle };
+    };
+
+    /**
+     * An object waiting for deletion.
+     */
+    struct Retired {
+        uint64_t epoch;
+        void* object;
+        void (*deleter)(void*);
+    };
+
+    /** The global epoch, advanced by every retire() */
+    std::atomic<uint64_t> globalEpoch{ 0 };
+
+    /** The reader slots */
+    Slot slots[kMaxReaders];
+
+    /** Objects waiting for deletion, oldest first */
+    std::vector<Retired> retired;
+
+    /**
+     * Claims a free reader slot, starting the search at a position derived from the calling thread.
+     * @return The index of the claimed slot.
+     */
+    size_t acquireSlot();
+};
+
+#endif /* EPOCHMANAGER_H_ */
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <utility>
+#include "FrequencyIndex.h"
+
+/**
+ * Creates a group.
+ * @param frequency The frequency of its Words.
+ * @param start Its first position.
+ * @param size Its number of positions.
+ * @return The index of the group.
+ */
+uint32_t FrequencyIndex::newGroup(int frequency, uint32_t start, uint32_t size) {
+    Group group{ frequency, start, size };
+    if (!freeGroups.empty()) {
+        uint32_t index = freeGroups.back();
+        freeGroups.pop_back();
+        groups[index] = group;
+        return index;
+    }
+    groups.push_back(group);
+    return static_cast<uint32_t>(groups.size() - 1);
+}
+
+/**
+ * Adds a Word that has just been seen for the first time (frequency 1).
+ * Frequency 1 is the lowest, so the Word goes at the back, joining the last group if that holds frequency 1.
+ * @param word The Word. It must stay in place while it is in the index.
+ * @return The id of the Word, for increment.
+ */
+uint32_t FrequencyIndex::add(const Word* word) {
+    uint32_t id = static_cast<uint32_t>(positionOf.size());
+    uint32_t position = static_cast<uint32_t>(order.size());
+    uint32_t group;
+    if (position > 0 && groups[groupAt[position - 1]].frequency == 1) {
+        group = groupAt[position - 1];
+        groups[group].size++;
+    } else {
+        group = newGroup(1, position, 1);
+    }
+    order.push_back(word);
+    idAt.push_back(id);
+    groupAt.push_back(group);
+    positionOf.push_back(position);
+    return id;
+}
+
+/**
+ * Records that a Word's frequency went up by one.
+ * The Word trades places with the first Word of its group, then that position moves from its old group
+ * to the group of the next higher frequency, which is either directly in front or created for it.
+ * @param id The id of the Word, as returned by add or assigned by rebuild.
+ */
+void FrequencyIndex::increment(uint32_t id) {
+    uint32_t position = positionOf[id];
+    uint32_t group = groupAt[position];
+    uint32_t first = groups[group].start;
+    int frequency = groups[group].frequency;
+
+    if (position != first) {
+        uint32_t otherId = idAt[first];
+        std::swap(order[position], order[first]);
+        idAt[position] = otherId;
+        idAt[first] = id;
+        positionOf[otherId] = position;
+        positionOf[id] = first;
+    }
+
+    groups[group].start++;
+    if (--groups[group].size == 0) {
+        freeGroups.push_back(group);
+    }
+    if (first > 0 && groups[groupAt[first - 1]].frequency == frequency + 1) {
+        uint32_t higher = groupAt[first - 1];
+        groups[higher].size++;
+        groupAt[first] = higher;
+    } else {
+        groupAt[first] = newGroup(frequency + 1, first, 1);
+    }
+}
+
+/**
+ * Replaces the contents with a list of Words of any frequency, giving each the id of its index in the list.
+ * @param words The Words.
+ */
+void FrequencyIndex::rebuild(const std::vector<const Word*>& words) {
+    clear();
+    size_t count = words.size();
+    idAt.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        idAt[i] = static_cast<uint32_t>(i);
+    }
+    std::stable_sort(idAt.begin(), idAt.end(), [&](uint32_t a, uint32_t b) {
+        return words[a]->getFrequency() > words[b]->getFrequency();
+    });
+    order.resize(count);
+    groupAt.resize(count);
+    positionOf.resize(count);
+    for (size_t position = 0; position < count; ++position) {
+        const Word* word = words[idAt[position]];
+        order[position] = word;
+        positionOf[idAt[position]] = static_cast<uint32_t>(position);
+        if (position > 0 && groups.back().frequency == word->getFrequency()) {
+            groups.back().size++;
+        } else {
+            newGroup(word->getFrequency(), static_cast<uint32_t>(position), 1);
+        }
+        groupAt[position] = static_cast<uint32_t>(groups.size() - 1);
+    }
+}
+
+/**
+ * Removes every Word.
+ */
+void FrequencyIndex::clear() {
+    order.clear();
+    idAt.clear();
+    groupAt.clear();
+    positionOf.clear();
+    groups.clear();
+    freeGroups.clear();
+}
+
+/**
+ * Returns the most frequent Words.
+ * @param k The maximum number of Words to return.
+ * @return Up to k Words by descending frequency (ties in no particular order).
+ */
+std::vector<const Word*> FrequencyIndex::top(size_t k) const {
+    return std::vector<const Word*>(order.begin(), order.begin() + std::min(k, order.size()));
+}
+
+/**
+ * Returns the number of Words in the index.
+ * @return The number of Words.
+ */
+size_t FrequencyIndex::size() const {
+    return order.size();
+}
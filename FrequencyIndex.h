@@ -0,0 +1,94 @@
+#ifndef FREQUENCYINDEX_H_
+#define FREQUENCYINDEX_H_
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Word.h"
+
+/**
+ * The FrequencyIndex class keeps the Words of a Dictionary ordered by frequency, most frequent first,
+ * so the top K words can be read off the front in O(K).
+ *
+ * Words with the same frequency form a contiguous group. When a Word's frequency goes up by one it is swapped
+ * with the first Word of its group and that position is handed over to the group just in front, so the order
+ * is maintained in O(1) per occurrence without comparing or moving anything else. Words are identified by
+ * the id returned when they were added. Within a group the order is arbitrary.
+ */
+class FrequencyIndex {
+private:
+    /**
+     * A run of positions holding Words with the same frequency.
+     */
+    struct Group {
+        int frequency;
+        uint32_t start;
+        uint32_t size;
+    };
+
+    /** The Words, by descending frequency */
+    std::vector<const Word*> order;
+
+    /** The id of the Word at each position of order */
+    std::vector<uint32_t> idAt;
+
+    /** The group of the Word at each position of order */
+    std::vector<uint32_t> groupAt;
+
+    /** The position in order of every id */
+    std::vector<uint32_t> positionOf;
+
+    /** The groups; unused entries are on the free list */
+    std::vector<Group> groups;
+
+    /** Indices of unused entries of groups */
+    std::vector<uint32_t> freeGroups;
+
+    /**
+     * Creates a group.
+     * @param frequency The frequency of its Words.
+     * @param start Its first position.
+     * @param size Its number of positions.
+     * @return The index of the group.
+     */
+    uint32_t newGroup(int frequency, uint32_t start, uint32_t size);
+
+public:
+    /**
+     * Adds a Word that has just been seen for the first time (frequency 1).
+     * @param word The Word. It must stay in place while it is in the index.
+     * @return The id of the Word, for increment.
+     */
+    uint32_t add(const Word* word);
+
+    /**
+     * Records that a Word's frequency went up by one.
+     * @param id The id of the Word, as returned by add or assigned by rebuild.
+     */
+    void increment(uint32_t id);
+
+    /**
+     * Replaces the contents with a list of Words of any frequency, giving each the id of its index in the list.
+     * @param words The Words.
+     */
+    void rebuild(const std::vector<const Word*>& words);
+
+    /**
+     * Removes every Word.
+     */
+    void clear();
+
+    /**
+     * Returns the most frequent Words.
+     * @param k The maximum number of Words to return.
+     * @return Up to k Words by descending frequency (ties in no particular order).
+     */
+    std::vector<const Word*> top(size_t k) const;
+
+    /**
+     * Returns the number of Words in the index.
+     * @return The number of Words.
+     */
+    size_t size() const;
+};
+
+#endif /* FREQUENCYINDEX_H_ */
@@ -0,0 +1,145 @@
+#include <utility>
+#include "MappedFile.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TEXTDICT_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <iterator>
+#endif
+
+/**
+ * Constructor that maps the given file read-only.
+ * @param filename The name of the file to map.
+ */
+MappedFile::MappedFile(const std::string& filename) {
+#ifdef TEXTDICT_HAVE_MMAP
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return;
+    }
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* region = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (region == MAP_FAILED) {
+            ::close(fd);
+            length = 0;
+            return;
+        }
+        // The file is parsed front to back exactly once
+        ::madvise(region, length, MADV_SEQUENTIAL);
+        pData = static_cast<const char*>(region);
+        mapped = true;
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+    opened = true;
+#else
+    std::ifstream fin(filename, std::ios::binary);
+    if (!fin) {
+        return;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+    pData = buffer.data();
+    length = buffer.size();
+    opened = true;
+#endif
+}
+
+/**
+ * Destructor that unmaps the file.
+ */
+MappedFile::~MappedFile() {
+    close();
+}
+
+/**
+ * Move constructor. Takes over the mapping of another MappedFile.
+ * @param other The MappedFile to take the mapping from.
+ */
+MappedFile::MappedFile(MappedFile&& other) noexcept
+        : pData(other.pData), length(other.length), opened(other.opened), mapped(other.mapped),
+          buffer(std::move(other.buffer)) {
+    other.pData = nullptr;
+    other.length = 0;
+    other.opened = false;
+    other.mapped = false;
+}
+
+/**
+ * Move assignment operator. Releases the current mapping and takes over the one of another MappedFile.
+ * @param other The MappedFile to take the mapping from.
+ * @return A reference to the updated MappedFile.
+ */
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        pData = other.pData;
+        length = other.length;
+        opened = other.opened;
+        mapped = other.mapped;
+        buffer = std::move(other.buffer);
+        other.pData = nullptr;
+        other.length = 0;
+        other.opened = false;
+        other.mapped = false;
+    }
+    return *this;
+}
+
+/**
+ * Release the mapping or buffer and reset to the closed state.
+ */
+void MappedFile::close() {
+#ifdef TEXTDICT_HAVE_MMAP
+    if (mapped) {
+        ::munmap(const_cast<char*>(pData), length);
+    }
+#endif
+    buffer.clear();
+    pData = nullptr;
+    length = 0;
+    opened = false;
+    mapped = false;
+}
+
+/**
+ * Checks whether the file was opened successfully.
+ * @return true if the file is open, false otherwise.
+ */
+MappedFile::operator bool() const {
+    return opened;
+}
+
+/**
+ * Returns the first byte of the file.
+ * @return A pointer to the mapped bytes.
+ */
+const char* MappedFile::data() const {
+    return pData;
+}
+
+/**
+ * Returns the size of the file in bytes.
+ * @return The number of mapped bytes.
+ */
+size_t MappedFile::size() const {
+    return length;
+}
+
+/**
+ * Returns the whole file as a string_view.
+ * @return A view of the mapped bytes.
+ */
+std::string_view MappedFile::view() const {
+    return std::string_view(pData, length);
+}
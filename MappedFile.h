@@ -0,0 +1,89 @@
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * The MappedFile class maps a whole file read-only into memory so it can be parsed in place.
+ * On platforms without mmap the file is read into a private buffer instead.
+ * Like std::ifstream, a MappedFile that failed to open converts to false.
+ */
+class MappedFile {
+private:
+    /** Start of the mapped bytes (nullptr if the file is empty or could not be opened) */
+    const char* pData{ nullptr };
+
+    /** Number of mapped bytes */
+    size_t length{ 0 };
+
+    /** Whether the file was opened successfully */
+    bool opened{ false };
+
+    /** Whether pData refers to an mmap region that must be unmapped */
+    bool mapped{ false };
+
+    /** Backing storage when the file is read instead of mapped */
+    std::vector<char> buffer;
+
+    /**
+     * Release the mapping or buffer and reset to the closed state.
+     */
+    void close();
+
+public:
+    /**
+     * Constructor that maps the given file.
+     * @param filename The name of the file to map.
+     */
+    explicit MappedFile(const std::string& filename);
+
+    /**
+     * Destructor that unmaps the file.
+     */
+    ~MappedFile();
+
+    // A mapping has a single owner.
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * Move constructor. Takes over the mapping of another MappedFile.
+     * @param other The MappedFile to take the mapping from.
+     */
+    MappedFile(MappedFile&& other) noexcept;
+
+    /**
+     * Move assignment operator. Releases the current mapping and takes over the one of another MappedFile.
+     * @param other The MappedFile to take the mapping from.
+     * @return A reference to the updated MappedFile.
+     */
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+     * Checks whether the file was opened successfully.
+     * @return true if the file is open, false otherwise.
+     */
+    explicit operator bool() const;
+
+    /**
+     * Returns the first byte of the file.
+     * @return A pointer to the mapped bytes.
+     */
+    const char* data() const;
+
+    /**
+     * Returns the size of the file in bytes.
+     * @return The number of mapped bytes.
+     */
+    size_t size() const;
+
+    /**
+     * Returns the whole file as a string_view.
+     * @return A view of the mapped bytes.
+     */
+    std::string_view view() const;
+};
+
+#endif /* MAPPEDFILE_H_ */
@@ -0,0 +1,97 @@
+#include "Normalizer.h"
+
+/**
+ * Checks for the characters stripPunctuation removes.
+ * @param c The character to check.
+ * @return true if c is ASCII punctuation.
+ */
+static bool isPunctuation(char c) {
+    return (c >= '!' && c <= '/') || (c >= ':' && c <= '@') || (c >= '[' && c <= '`') || (c >= '{' && c <= '~');
+}
+
+/**
+ * Checks whether a token ends with a suffix.
+ * @param token The token.
+ * @param suffix The suffix.
+ * @return true if the last characters of token are suffix.
+ */
+static bool endsWith(std::string_view token, std::string_view suffix) {
+    return token.size() >= suffix.size() && token.substr(token.size() - suffix.size()) == suffix;
+}
+
+/**
+ * Removes punctuation at the start and end of a token.
+ * @param token The token.
+ * @return The token without leading and trailing punctuation.
+ */
+std::string_view Normalizer::stripPunctuation(std::string_view token) {
+    size_t first = 0;
+    size_t last = token.size();
+    while (first < last && isPunctuation(token[first])) {
+        ++first;
+    }
+    while (last > first && isPunctuation(token[last - 1])) {
+        --last;
+    }
+    return token.substr(first, last - first);
+}
+
+/**
+ * Lower-cases the ASCII letters of a token. Tokens without upper-case letters, the common case, are not copied.
+ * @param token The token.
+ * @param scratch Receives the lower-cased characters, unless the token has no upper-case letter.
+ * @return The lower-cased token, a view into token or scratch.
+ */
+std::string_view Normalizer::foldCase(std::string_view token, std::string& scratch) {
+    size_t i = 0;
+    while (i < token.size() && !(token[i] >= 'A' && token[i] <= 'Z')) {
+        ++i;
+    }
+    if (i == token.size()) {
+        return token;
+    }
+    scratch.assign(token.data(), token.size());
+    for (; i < scratch.size(); ++i) {
+        char c = scratch[i];
+        if (c >= 'A' && c <= 'Z') {
+            scratch[i] = static_cast<char>(c - 'A' + 'a');
+        }
+    }
+    return scratch;
+}
+
+/**
+ * Reduces a plural to the singular with Harman's S-stemmer.
+ * Only "-ies" needs new characters; the other rules just cut the token short.
+ * @param token The token.
+ * @param scratch Receives the stem when it does not end the same way as the token. May hold token itself.
+ * @return The stem, a view into token or scratch.
+ */
+std::string_view Normalizer::stem(std::string_view token, std::string& scratch) {
+    if (token.size() <= 3 || token.back() != 's') {
+        return token;
+    }
+    if (endsWith(token, "ies")) {
+        if (endsWith(token, "eies") || endsWith(token, "aies")) {
+            return token;
+        }
+        size_t keep = token.size() - 3;
+        if (token.data() == scratch.data()) {
+            scratch.resize(keep);
+        } else {
+            scratch.assign(token.data(), keep);
+        }
+        scratch.push_back('y');
+        return scratch;
+    }
+    if (endsWith(token, "es")) {
+        if (endsWith(token, "aes") || endsWith(token, "ees") || endsWith(token, "oes")) {
+            return token;
+        }
+        return token.substr(0, token.size() - 1);
+    }
+    if (endsWith(token, "us") || endsWith(token, "ss")) {
+        return token;
+    }
+    return token.substr(0, token.size() - 1);
+}
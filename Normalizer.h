@@ -0,0 +1,130 @@
+#ifndef NORMALIZER_H_
+#define NORMALIZER_H_
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/**
+ * The steps that turn a token from the text into the word stored in a Dictionary. Steps combine with |
+ * and always run in the order they are listed here.
+ */
+enum class Normalization : unsigned {
+    /** Store every token exactly as it appears in the text */
+    Verbatim = 0,
+    /** Remove punctuation at the start and end of a token: "(the," becomes "the", "don't" is kept */
+    StripPunctuation = 1,
+    /** Lower-case the ASCII letters of a token: "The" becomes "the" */
+    CaseFold = 2,
+    /** Reduce plural forms to the singular with the S-stemmer: "queries" becomes "query" */
+    Stem = 4
+};
+
+/**
+ * Combines normalization steps.
+ * @param a The first steps.
+ * @param b The second steps.
+ * @return Both sets of steps.
+ */
+constexpr Normalization operator|(Normalization a, Normalization b) {
+    return static_cast<Normalization>(static_cast<unsigned>(a) | static_cast<unsigned>(b));
+}
+
+/**
+ * The Normalizer class applies a set of Normalization steps to the tokens of a text.
+ * The steps are a template parameter of apply, so each combination compiles to its own straight-line code with
+ * no branches on the settings; dispatch picks the instantiation once per block of text rather than once per
+ * token. apply<Verbatim> returns the token untouched, so the default path costs nothing.
+ */
+class Normalizer {
+public:
+    /** Every combination of steps is below this value */
+    static constexpr unsigned kCombinations = 8;
+
+    /**
+     * Normalizes one token.
+     * @tparam Steps The Normalization steps, as an unsigned bit set.
+     * @param token The token from the text.
+     * @param scratch Storage for the result when a step has to change characters rather than cut the token.
+     * @return The normalized word, a view into token or scratch. Empty if nothing of the token is left.
+     */
+    template <unsigned Steps>
+    static std::string_view apply(std::string_view token, std::string& scratch);
+
+    /**
+     * Calls visit with the steps as a compile-time constant, so the caller can instantiate apply for them.
+     * @param steps The Normalization steps.
+     * @param visit The callable receiving a std::integral_constant<unsigned, steps>.
+     * @return What visit returns.
+     */
+    template <typename Visitor>
+    static decltype(auto) dispatch(Normalization steps, Visitor&& visit);
+
+    /**
+     * Removes punctuation at the start and end of a token.
+     * @param token The token.
+     * @return The token without leading and trailing punctuation.
+     */
+    static std::string_view stripPunctuation(std::string_view token);
+
+    /**
+     * Lower-cases the ASCII letters of a token.
+     * @param token The token.
+     * @param scratch Receives the lower-cased characters, unless the token has no upper-case letter.
+     * @return The lower-cased token, a view into token or scratch.
+     */
+    static std::string_view foldCase(std::string_view token, std::string& scratch);
+
+    /**
+     * Reduces a plural to the singular with Harman's S-stemmer: "-ies" becomes "-y" (except "-eies", "-aies"),
+     * "-es" becomes "-e" (except "-aes", "-ees", "-oes"), and a final "-s" is dropped (except "-us", "-ss").
+     * Tokens of three characters or fewer ("is", "was") are left alone, and only lower-case suffixes are recognized.
+     * @param token The token.
+     * @param scratch Receives the stem when it does not end the same way as the token.
+     * @return The stem, a view into token or scratch.
+     */
+    static std::string_view stem(std::string_view token, std::string& scratch);
+};
+
+/**
+ * Normalizes one token.
+ * @tparam Steps The Normalization steps, as an unsigned bit set.
+ * @param token The token from the text.
+ * @param scratch Storage for the result when a step has to change characters rather than cut the token.
+ * @return The normalized word, a view into token or scratch. Empty if nothing of the token is left.
+ */
+template <unsigned Steps>
+std::string_view Normalizer::apply(std::string_view token, std::string& scratch) {
+    if constexpr ((Steps & static_cast<unsigned>(Normalization::StripPunctuation)) != 0) {
+        token = stripPunctuation(token);
+    }
+    if constexpr ((Steps & static_cast<unsigned>(Normalization::CaseFold)) != 0) {
+        token = foldCase(token, scratch);
+    }
+    if constexpr ((Steps & static_cast<unsigned>(Normalization::Stem)) != 0) {
+        token = stem(token, scratch);
+    }
+    return token;
+}
+
+/**
+ * Calls visit with the steps as a compile-time constant, so the caller can instantiate apply for them.
+ * @param steps The Normalization steps.
+ * @param visit The callable receiving a std::integral_constant<unsigned, steps>.
+ * @return What visit returns.
+ */
+template <typename Visitor>
+decltype(auto) Normalizer::dispatch(Normalization steps, Visitor&& visit) {
+    switch (static_cast<unsigned>(steps) % kCombinations) {
+    case 1: return visit(std::integral_constant<unsigned, 1>());
+    case 2: return visit(std::integral_constant<unsigned, 2>());
+    case 3: return visit(std::integral_constant<unsigned, 3>());
+    case 4: return visit(std::integral_constant<unsigned, 4>());
+    case 5: return visit(std::integral_constant<unsigned, 5>());
+    case 6: return visit(std::integral_constant<unsigned, 6>());
+    case 7: return visit(std::integral_constant<unsigned, 7>());
+    default: return visit(std::integral_constant<unsigned, 0>());
+    }
+}
+
+#endif /* NORMALIZER_H_ */
@@ -1,32 +1,251 @@
 #include "NumList.h"
+#include "OutputBuffer.h"
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define NUMLIST_SSE2 1
+#endif
+
 /**
- * Default constructor that creates an empty list of capacity 1 and size 0.
+ * Maps a signed difference to an unsigned value so small negative differences also encode in few bytes.
+ * @param delta The difference to encode.
+ * @return The zigzag-encoded difference.
  */
-NumList::NumList() : capacity(1), size(0), pArray(new int[1]) {}
+static inline uint32_t zigzag(uint32_t delta) {
+    return (delta << 1) ^ (0u - (delta >> 31));
+}
+
+/**
+ * Reverses zigzag().
+ * @param encoded The zigzag-encoded difference.
+ * @return The difference.
+ */
+static inline uint32_t unzigzag(uint32_t encoded) {
+    return (encoded >> 1) ^ (0u - (encoded & 1u));
+}
+
+/**
+ * Writes a value as a little-endian base-128 varint.
+ * @param value The value to write.
+ * @param out The destination; it must have room for 5 bytes.
+ * @return The number of bytes written.
+ */
+static inline int writeVarint(uint32_t value, unsigned char* out) {
+    int n = 0;
+    while (value >= 0x80) {
+        out[n++] = static_cast<unsigned char>(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = static_cast<unsigned char>(value);
+    return n;
+}
+
+/**
+ * Reads a little-endian base-128 varint and advances the cursor past it.
+ * @param cursor The position of the first byte; moved past the varint.
+ * @return The value read.
+ */
+static inline uint32_t readVarint(const unsigned char*& cursor) {
+    uint32_t value = *cursor & 0x7F;
+    int shift = 7;
+    while (*cursor++ & 0x80) {
+        value |= static_cast<uint32_t>(*cursor & 0x7F) << shift;
+        shift += 7;
+    }
+    return value;
+}
+
+/**
+ * Appends a value to a sorted result unless it equals the last value appended.
+ * @param out The result.
+ * @param value The value, not less than the last value appended.
+ */
+static inline void appendDistinct(std::vector<int>& out, int value) {
+    if (out.empty() || out.back() != value) {
+        out.push_back(value);
+    }
+}
+
+/**
+ * Intersects two sorted arrays by walking both.
+ * @param a The first array.
+ * @param na The length of the first array.
+ * @param b The second array.
+ * @param nb The length of the second array.
+ * @param out Receives the common values without repeats.
+ */
+static void intersectMerge(const int* a, int na, const int* b, int nb, std::vector<int>& out) {
+    int i = 0;
+    int j = 0;
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (b[j] < a[i]) {
+            j++;
+        } else {
+            appendDistinct(out, a[i]);
+            i++;
+            j++;
+        }
+    }
+}
+
+/**
+ * Intersects a short sorted array with a much longer one, finding each value of the short array by
+ * exponential then binary search from where the previous one was found: O(ns log(nl / ns)).
+ * @param small The short array.
+ * @param ns The length of the short array.
+ * @param large The long array.
+ * @param nl The length of the long array.
+ * @param out Receives the common values without repeats.
+ */
+static void intersectGalloping(const int* small, int ns, const int* large, int nl, std::vector<int>& out) {
+    int position = 0;
+    for (int i = 0; i < ns && position < nl; i++) {
+        int value = small[i];
+        if (i > 0 && value == small[i - 1]) {
+            continue;
+        }
+        int step = 1;
+        while (position + step < nl && large[position + step] < value) {
+            step *= 2;
+        }
+        int high = std::min(position + step + 1, nl);
+        position = static_cast<int>(std::lower_bound(large + position + step / 2, large + high, value) - large);
+        if (position < nl && large[position] == value) {
+            appendDistinct(out, value);
+        }
+    }
+}
+
+/**
+ * Intersects two sorted arrays of similar length, comparing a block of four values of one against every
+ * rotation of a block of four of the other with SSE2, then advancing the block with the smaller maximum.
+ * A value that repeats across blocks is still found in at least one block pair, so no common value is lost.
+ * @param a The first array.
+ * @param na The length of the first array.
+ * @param b The second array.
+ * @param nb The length of the second array.
+ * @param out Receives the common values without repeats.
+ */
+static void intersectBlocks(const int* a, int na, const int* b, int nb, std::vector<int>& out) {
+    int i = 0;
+    int j = 0;
+#ifdef NUMLIST_SSE2
+    while (i + 4 <= na && j + 4 <= nb) {
+        __m128i blockA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        __m128i blockB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + j));
+        __m128i match = _mm_cmpeq_epi32(blockA, blockB);
+        match = _mm_or_si128(match, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, 0x39)));
+        match = _mm_or_si128(match, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, 0x4E)));
+        match = _mm_or_si128(match, _mm_cmpeq_epi32(blockA, _mm_shuffle_epi32(blockB, 0x93)));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(match));
+        for (int k = 0; mask != 0; k++, mask >>= 1) {
+            if (mask & 1) {
+                appendDistinct(out, a[i + k]);
+            }
+        }
+        int maxA = a[i + 3];
+        int maxB = b[j + 3];
+        if (maxA <= maxB) {
+            i += 4;
+        }
+        if (maxB <= maxA) {
+            j += 4;
+        }
+    }
+#endif
+    intersectMerge(a + i, na - i, b + j, nb - j, out);
+}
+
+/**
+ * Intersects two sorted arrays, picking galloping search when one is much longer than the other.
+ * @param a The first array.
+ * @param na The length of the first array.
+ * @param b The second array.
+ * @param nb The length of the second array.
+ * @param out Receives the common values without repeats.
+ */
+static void intersectArrays(const int* a, int na, const int* b, int nb, std::vector<int>& out) {
+    const int kGallopRatio = 32; // Beyond this length ratio galloping beats a linear walk
+    if (na > nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (na == 0) {
+        return;
+    }
+    if (nb / na >= kGallopRatio) {
+        intersectGalloping(a, na, b, nb, out);
+    } else {
+        intersectBlocks(a, na, b, nb, out);
+    }
+}
+
+/**
+ * Merges two sorted arrays into their union.
+ * @param a The first array.
+ * @param na The length of the first array.
+ * @param b The second array.
+ * @param nb The length of the second array.
+ * @param out Receives every value without repeats.
+ */
+static void uniteArrays(const int* a, int na, const int* b, int nb, std::vector<int>& out) {
+    out.reserve(out.size() + na + nb);
+    int i = 0;
+    int j = 0;
+    while (i < na || j < nb) {
+        if (j == nb || (i < na && a[i] <= b[j])) {
+            appendDistinct(out, a[i++]);
+        } else {
+            appendDistinct(out, b[j++]);
+        }
+    }
+}
+
+/**
+ * Default constructor that creates an empty list in the inline buffer, with capacity kInlineCapacity and size 0.
+ */
+NumList::NumList()
+        : pArray(inlineBuffer), capacity(kInlineCapacity), size(0), byteSize(0), lastValue(0), compressed(false) {}
 
 /**
  * Copy constructor. Creates a new list that is a copy of an existing list.
  * @param other The list to be copied.
  */
 NumList::NumList(const NumList& other)
-        : capacity(other.capacity), size(other.size), pArray(new int[other.capacity]) {
+        : pArray(inlineBuffer), capacity(kInlineCapacity), size(0), byteSize(0), lastValue(0), compressed(false) {
+    if (other.capacity > kInlineCapacity) {
+        capacity = other.capacity;
+        pArray = new int[other.capacity];
+    }
     // Copy the elements of the other array into this array
-    std::copy(other.pArray, other.pArray + other.size, pArray);
+    copyContents(other);
 }
 
 /**
  * Move constructor. Transfers the ownership of an existing list to a new list.
+ * Elements in the other list's inline buffer are copied, since that buffer cannot change owner.
  * @param other The list to transfer ownership from.
  */
 NumList::NumList(NumList&& other) noexcept
-        : capacity(other.capacity), size(other.size), pArray(other.pArray) {
-    // Leave other in a valid but unspecified state
-    other.pArray = nullptr;
-    other.capacity = 0;
+        : pArray(inlineBuffer), capacity(kInlineCapacity), size(0), byteSize(0), lastValue(0), compressed(false) {
+    if (!other.isInline()) {
+        pArray = other.pArray;
+        capacity = other.capacity;
+    }
+    copyContents(other);
+    // Leave other as a valid, empty list
+    other.pArray = other.inlineBuffer;
+    other.capacity = kInlineCapacity;
     other.size = 0;
+    other.byteSize = 0;
+    other.lastValue = 0;
+    other.compressed = false;
 }
 
 /**
@@ -37,12 +256,17 @@ NumList::NumList(NumList&& other) noexcept
 NumList& NumList::operator=(const NumList& other) {
     if (this != &other) {
         // Free the current array
-        delete[] pArray;
+        if (!isInline()) {
+            delete[] pArray;
+        }
         // Copy the properties of the other object
-        capacity = other.capacity;
-        size = other.size;
-        pArray = new int[other.capacity];
-        std::copy(other.pArray, other.pArray + other.size, pArray);
+        pArray = inlineBuffer;
+        capacity = kInlineCapacity;
+        if (other.capacity > kInlineCapacity) {
+            capacity = other.capacity;
+            pArray = new int[other.capacity];
+        }
+        copyContents(other);
     }
     return *this;
 }
@@ -55,15 +279,24 @@ NumList& NumList::operator=(const NumList& other) {
 NumList& NumList::operator=(NumList&& other) noexcept {
     if (this != &other) {
         // Free the current array
-        delete[] pArray;
+        if (!isInline()) {
+            delete[] pArray;
+        }
         // Take ownership of the other object's resources
-        capacity = other.capacity;
-        size = other.size;
-        pArray = other.pArray;
-        // Leave other in a valid but unspecified state
-        other.pArray = nullptr;
-        other.capacity = 0;
+        pArray = inlineBuffer;
+        capacity = kInlineCapacity;
+        if (!other.isInline()) {
+            pArray = other.pArray;
+            capacity = other.capacity;
+        }
+        copyContents(other);
+        // Leave other as a valid, empty list
+        other.pArray = other.inlineBuffer;
+        other.capacity = kInlineCapacity;
         other.size = 0;
+        other.byteSize = 0;
+        other.lastValue = 0;
+        other.compressed = false;
     }
     return *this;
 }
@@ -72,8 +305,10 @@ NumList& NumList::operator=(NumList&& other) noexcept {
  * Destructor. Deallocates the memory used by the list.
  */
 NumList::~NumList() {
-    // Free the dynamic array
-    delete[] pArray;
+    // Free the dynamic array, if the list ever needed one
+    if (!isInline()) {
+        delete[] pArray;
+    }
 }
 
 /**
@@ -85,10 +320,14 @@ bool NumList::empty() const {
 }
 
 /**
- * Checks if the list is full.
+ * Checks if the list is full, i.e. the next append needs to expand it.
+ * In compressed mode that is when fewer bytes are left than the longest encoding of one element.
  * @return true if the list is full, false otherwise.
  */
 bool NumList::full() const {
+    if (compressed) {
+        return byteSize + kMaxVarintBytes > capacity * static_cast<int>(sizeof(int));
+    }
     return size == capacity;
 }
 
@@ -104,20 +343,12 @@ int NumList::getSize() const {
  * Expands the capacity of the list. The new capacity is twice the old capacity.
  */
 void NumList::expand() {
-    // Allocate a new array with double the capacity
-    int* newArray = new int[capacity * 2];
-    // Copy the elements to the new array
-    std::copy(pArray, pArray + size, newArray);
-    // Free the old array
-    delete[] pArray;
-    // Update pArray and capacity
-    pArray = newArray;
-    capacity *= 2;
+    reallocate(capacity * 2);
 }
 
 /**
  * Gets the capacity of the list.
- * @return The capacity of the list.
+ * @return The capacity of the list, in ints.
  */
 int NumList::getCapacity() const {
     return capacity;
@@ -129,6 +360,14 @@ int NumList::getCapacity() const {
  * @return true if the list contains the element, false otherwise.
  */
 bool NumList::contains(int x) const {
+    if (compressed) {
+        for (int value : *this) {
+            if (value == x) {
+                return true;
+            }
+        }
+        return false;
+    }
     for (int i = 0; i < size; i++) {
         if (pArray[i] == x) {
             return true;
@@ -146,20 +385,130 @@ void NumList::append(int x) {
         // If the list is full, expand it
         expand();
     }
+    if (compressed) {
+        uint32_t delta = static_cast<uint32_t>(x) - static_cast<uint32_t>(lastValue);
+        byteSize += writeVarint(zigzag(delta), bytes() + byteSize);
+        lastValue = x;
+        size++;
+        return;
+    }
     pArray[size++] = x;
 }
 
+/**
+ * Appends every element of another list to the end of this list, adding an offset to each one.
+ * The capacity is grown once up front instead of once per element. Between two compressed lists only the
+ * first element is re-encoded; the remaining differences are copied byte for byte.
+ * @param other The list whose elements are appended.
+ * @param offset The amount added to each appended element.
+ */
+void NumList::append(const NumList& other, int offset) {
+    if (other.size == 0) {
+        return;
+    }
+    if (this == &other) {
+        // Work from a snapshot so the source does not change while it is read
+        NumList copy(other);
+        append(copy, offset);
+        return;
+    }
+    if (compressed) {
+        if (!other.compressed) {
+            for (int i = 0; i < other.size; i++) {
+                append(other.pArray[i] + offset);
+            }
+            return;
+        }
+        const unsigned char* cursor = other.bytes();
+        int first = static_cast<int>(unzigzag(readVarint(cursor)));
+        int headerBytes = static_cast<int>(cursor - other.bytes());
+        int tailBytes = other.byteSize - headerBytes;
+        reserveSlots((byteSize + kMaxVarintBytes + tailBytes + kMaxVarintBytes + 3) / 4);
+        append(first + offset);
+        std::memcpy(bytes() + byteSize, cursor, tailBytes);
+        byteSize += tailBytes;
+        size += other.size - 1;
+        lastValue = other.lastValue + offset;
+        return;
+    }
+    int needed = size + other.size;
+    reserveSlots(needed);
+    if (other.compressed) {
+        for (int value : other) {
+            pArray[size++] = value + offset;
+        }
+        return;
+    }
+    for (int i = 0; i < other.size; i++) {
+        pArray[size + i] = other.pArray[i] + offset;
+    }
+    size = needed;
+}
+
+/**
+ * Adds the same amount to every element in the list.
+ * In compressed mode only the first element changes; the differences stay as they are.
+ * @param delta The amount to add.
+ */
+void NumList::shift(int delta) {
+    if (!compressed) {
+        for (int i = 0; i < size; i++) {
+            pArray[i] += delta;
+        }
+        return;
+    }
+    if (size == 0) {
+        return;
+    }
+    const unsigned char* cursor = bytes();
+    uint32_t first = unzigzag(readVarint(cursor));
+    int oldBytes = static_cast<int>(cursor - bytes());
+    unsigned char encoded[kMaxVarintBytes];
+    int newBytes = writeVarint(zigzag(first + static_cast<uint32_t>(delta)), encoded);
+    reserveSlots((byteSize - oldBytes + newBytes + kMaxVarintBytes + 3) / 4);
+    std::memmove(bytes() + newBytes, bytes() + oldBytes, byteSize - oldBytes);
+    std::memcpy(bytes(), encoded, newBytes);
+    byteSize += newBytes - oldBytes;
+    lastValue += delta;
+}
+
 /**
  * Prints the elements of the list to an output stream.
  * @param out The output stream to write to.
  * @param indentLevel The indentation level (unused).
  */
 void NumList::print(std::ostream& out, int indentLevel) const {
-    for (int i = 0; i < size; i++) {
-        out << pArray[i];
+    int i = 0;
+    for (int value : *this) {
+        out << value;
         if (i != size - 1) {
             out << ", ";
         }
+        i++;
+    }
+}
+
+/**
+ * Appends the list to an output buffer, in the same format as print(std::ostream&).
+ * @param out The buffer to append to.
+ */
+void NumList::print(OutputBuffer& out) const {
+    if (size == 0) {
+        return;
+    }
+    if (!compressed) {
+        out.append(pArray[0]);
+        for (int i = 1; i < size; i++) {
+            out.append(", ");
+            out.append(pArray[i]);
+        }
+        return;
+    }
+    const_iterator it = begin();
+    out.append(*it);
+    for (++it; it != end(); ++it) {
+        out.append(", ");
+        out.append(*it);
     }
 }
 
@@ -170,15 +519,17 @@ void NumList::print(std::ostream& out, int indentLevel) const {
  * @throws std::out_of_range If the index is out of range.
  */
 int NumList::get(int index) const {
-    if (index < 0 || index >= size) {
+    int value;
+    if (!get(index, value)) {
         // If the index is out of range, throw an exception
         throw std::out_of_range("Index out of range");
     }
-    return pArray[index];
+    return value;
 }
 
 /**
  * Retrieves the element at a specific position in the list and assigns it to a reference parameter.
+ * In compressed mode the elements before it are decoded first.
  * @param index The position of the element to retrieve.
  * @param value Reference parameter to assign the retrieved element to.
  * @return true if the element was successfully retrieved, false if the index is out of range.
@@ -188,12 +539,413 @@ bool NumList::get(int index, int& value) const {
         // If the index is out of range, return false
         return false;
     }
+    if (compressed) {
+        const_iterator it = begin();
+        while (it.index < index) {
+            ++it;
+        }
+        value = *it;
+        return true;
+    }
     // Assign the value at the index to the reference parameter
     value = pArray[index];
     // Return true to indicate success
     return true;
 }
 
+/**
+ * Switches the list to the delta + varint compressed mode and shrinks the storage to fit.
+ */
+void NumList::compress() {
+    if (compressed) {
+        return;
+    }
+    // The encoding can be longer than the ints while it is written, so encode into a scratch buffer
+    unsigned char* encoded = new unsigned char[static_cast<size_t>(size) * kMaxVarintBytes + 1];
+    int length = 0;
+    uint32_t previous = 0;
+    for (int i = 0; i < size; i++) {
+        length += writeVarint(zigzag(static_cast<uint32_t>(pArray[i]) - previous), encoded + length);
+        previous = static_cast<uint32_t>(pArray[i]);
+    }
+    lastValue = static_cast<int>(previous);
+
+    // Keep room for at least one more element
+    int slots = (length + kMaxVarintBytes + 3) / 4;
+    int newCapacity = kInlineCapacity;
+    while (newCapacity < slots) {
+        newCapacity *= 2;
+    }
+    if (!isInline()) {
+        delete[] pArray;
+    }
+    pArray = newCapacity > kInlineCapacity ? new int[newCapacity] : inlineBuffer;
+    capacity = newCapacity;
+    std::memcpy(bytes(), encoded, length);
+    delete[] encoded;
+    byteSize = length;
+    compressed = true;
+}
+
+/**
+ * Switches the list back to storing plain ints.
+ */
+void NumList::decompress() {
+    if (!compressed) {
+        return;
+    }
+    int newCapacity = kInlineCapacity;
+    while (newCapacity < size) {
+        newCapacity *= 2;
+    }
+    int* decoded = new int[newCapacity];
+    copyTo(decoded);
+    if (newCapacity == kInlineCapacity) {
+        // Small enough for the inline buffer
+        if (!isInline()) {
+            delete[] pArray;
+        }
+        pArray = inlineBuffer;
+        std::copy(decoded, decoded + size, inlineBuffer);
+        delete[] decoded;
+    } else {
+        if (!isInline()) {
+            delete[] pArray;
+        }
+        pArray = decoded;
+    }
+    capacity = newCapacity;
+    byteSize = 0;
+    lastValue = 0;
+    compressed = false;
+}
+
+/**
+ * Checks whether the list is in compressed mode.
+ * @return true if the elements are stored delta + varint encoded, false otherwise.
+ */
+bool NumList::isCompressed() const {
+    return compressed;
+}
+
+/**
+ * Writes every element, decoded, to an array.
+ * Runs of eight one-byte differences, the common case for line numbers, are decoded eight at a time
+ * from a single 64-bit load.
+ * @param out The destination; it must have room for getSize() ints.
+ */
+void NumList::copyTo(int* out) const {
+    if (!compressed) {
+        std::copy(pArray, pArray + size, out);
+        return;
+    }
+    const unsigned char* cursor = bytes();
+    const unsigned char* last = cursor + byteSize;
+    uint32_t value = 0;
+    int i = 0;
+    while (i < size) {
+        if (last - cursor >= 8) {
+            uint64_t chunk;
+            std::memcpy(&chunk, cursor, 8);
+            if ((chunk & 0x8080808080808080ull) == 0) {
+                // Eight complete one-byte varints
+                for (int k = 0; k < 8; k++) {
+                    value += unzigzag(static_cast<uint32_t>(chunk >> (8 * k)) & 0x7Fu);
+                    out[i++] = static_cast<int>(value);
+                }
+                cursor += 8;
+                continue;
+            }
+        }
+        value += unzigzag(readVarint(cursor));
+        out[i++] = static_cast<int>(value);
+    }
+}
+
+/**
+ * Appends the delta + varint encoding of the elements to a string.
+ * A compressed list already holds exactly these bytes, so they are copied as they are.
+ * @param out The string the encoded bytes are appended to.
+ */
+void NumList::encodeTo(std::string& out) const {
+    if (compressed) {
+        out.append(reinterpret_cast<const char*>(bytes()), byteSize);
+        return;
+    }
+    unsigned char encoded[kMaxVarintBytes];
+    uint32_t previous = 0;
+    for (int i = 0; i < size; i++) {
+        int length = writeVarint(zigzag(static_cast<uint32_t>(pArray[i]) - previous), encoded);
+        out.append(reinterpret_cast<const char*>(encoded), length);
+        previous = static_cast<uint32_t>(pArray[i]);
+    }
+}
+
+/**
+ * Replaces the contents of the list with elements given in their delta + varint encoding.
+ * @param data The encoded bytes, as produced by encodeTo.
+ * @param length The number of encoded bytes.
+ * @param count The number of elements encoded in data.
+ */
+void NumList::assignEncoded(const unsigned char* data, int length, int count) {
+    int slots = (length + kMaxVarintBytes + 3) / 4;
+    if (slots > capacity) {
+        int newCapacity = capacity;
+        while (newCapacity < slots) {
+            newCapacity *= 2;
+        }
+        if (!isInline()) {
+            delete[] pArray;
+        }
+        pArray = new int[newCapacity];
+        capacity = newCapacity;
+    }
+    std::memcpy(bytes(), data, length);
+    byteSize = length;
+    size = count;
+    compressed = true;
+
+    // The next append is encoded against the last element
+    uint32_t value = 0;
+    const unsigned char* cursor = data;
+    for (int i = 0; i < count; i++) {
+        value += unzigzag(readVarint(cursor));
+    }
+    lastValue = static_cast<int>(value);
+}
+
+/**
+ * Computes the distinct values that occur in both of two sorted lists.
+ * @param a The first list, in non-decreasing order.
+ * @param b The second list, in non-decreasing order.
+ * @return A plain list of the common values, in increasing order without repeats.
+ */
+NumList NumList::intersectionOf(const NumList& a, const NumList& b) {
+    std::vector<int> scratchA;
+    std::vector<int> scratchB;
+    std::vector<int> common;
+    intersectArrays(a.contiguous(scratchA), a.size, b.contiguous(scratchB), b.size, common);
+    return fromValues(common);
+}
+
+/**
+ * Computes the distinct values that occur in every one of several sorted lists.
+ * @param lists The lists, each in non-decreasing order.
+ * @return A plain list of the common values, in increasing order without repeats (empty if lists is empty).
+ */
+NumList NumList::intersectionOf(const std::vector<const NumList*>& lists) {
+    if (lists.empty()) {
+        return NumList();
+    }
+    std::vector<const NumList*> bySize(lists);
+    std::sort(bySize.begin(), bySize.end(), [](const NumList* x, const NumList* y) { return x->size < y->size; });
+
+    std::vector<int> scratch;
+    const int* first = bySize[0]->contiguous(scratch);
+    std::vector<int> common;
+    for (int i = 0; i < bySize[0]->size; i++) {
+        appendDistinct(common, first[i]);
+    }
+    std::vector<int> next;
+    for (size_t k = 1; k < bySize.size() && !common.empty(); k++) {
+        next.clear();
+        intersectArrays(common.data(), static_cast<int>(common.size()),
+                        bySize[k]->contiguous(scratch), bySize[k]->size, next);
+        common.swap(next);
+    }
+    return fromValues(common);
+}
+
+/**
+ * Computes the distinct values that occur in either of two sorted lists.
+ * @param a The first list, in non-decreasing order.
+ * @param b The second list, in non-decreasing order.
+ * @return A plain list of all values, in increasing order without repeats.
+ */
+NumList NumList::unionOf(const NumList& a, const NumList& b) {
+    std::vector<int> scratchA;
+    std::vector<int> scratchB;
+    std::vector<int> all;
+    uniteArrays(a.contiguous(scratchA), a.size, b.contiguous(scratchB), b.size, all);
+    return fromValues(all);
+}
+
+/**
+ * Computes the distinct values that occur in any of several sorted lists, merging them pairwise in a tree
+ * so every value is copied O(log lists.size()) times.
+ * @param lists The lists, each in non-decreasing order.
+ * @return A plain list of all values, in increasing order without repeats.
+ */
+NumList NumList::unionOf(const std::vector<const NumList*>& lists) {
+    std::vector<std::vector<int>> runs;
+    runs.reserve(lists.size());
+    for (const NumList* list : lists) {
+        std::vector<int> scratch;
+        const int* values = list->contiguous(scratch);
+        runs.emplace_back(values, values + list->size);
+    }
+    if (runs.empty()) {
+        return NumList();
+    }
+    while (runs.size() > 1) {
+        std::vector<std::vector<int>> merged((runs.size() + 1) / 2);
+        for (size_t k = 0; k + 1 < runs.size(); k += 2) {
+            uniteArrays(runs[k].data(), static_cast<int>(runs[k].size()),
+                        runs[k + 1].data(), static_cast<int>(runs[k + 1].size()), merged[k / 2]);
+        }
+        if (runs.size() % 2 != 0) {
+            merged.back().swap(runs.back());
+        }
+        runs.swap(merged);
+    }
+    std::vector<int> all;
+    uniteArrays(runs[0].data(), static_cast<int>(runs[0].size()), nullptr, 0, all); // Drop repeats of a lone list
+    return fromValues(all);
+}
+
+/**
+ * Intersection operator (see intersectionOf).
+ * @param other The list to intersect with.
+ * @return The distinct values in both lists.
+ */
+NumList NumList::operator&(const NumList& other) const {
+    return intersectionOf(*this, other);
+}
+
+/**
+ * Union operator (see unionOf).
+ * @param other The list to unite with.
+ * @return The distinct values in either list.
+ */
+NumList NumList::operator|(const NumList& other) const {
+    return unionOf(*this, other);
+}
+
+/**
+ * Returns the number of heap bytes used for the elements.
+ * @return 0 while the elements fit inline, otherwise the size of the dynamic array.
+ */
+size_t NumList::heapBytes() const {
+    return isInline() ? 0 : static_cast<size_t>(capacity) * sizeof(int);
+}
+
+/**
+ * Returns an iterator to the first element.
+ * @return An iterator to the first element.
+ */
+NumList::const_iterator NumList::begin() const {
+    const_iterator it;
+    it.list = this;
+    it.cursor = bytes();
+    it.load();
+    return it;
+}
+
+/**
+ * Returns an iterator past the last element.
+ * @return An iterator past the last element.
+ */
+NumList::const_iterator NumList::end() const {
+    const_iterator it;
+    it.list = this;
+    it.index = size;
+    return it;
+}
+
+/**
+ * Reads the element at the iterator's index, decoding it if the list is compressed.
+ */
+void NumList::const_iterator::load() {
+    if (index >= list->size) {
+        return;
+    }
+    if (list->compressed) {
+        value = static_cast<int>(static_cast<uint32_t>(value) + unzigzag(readVarint(cursor)));
+    } else {
+        value = list->pArray[index];
+    }
+}
+
+/**
+ * Checks whether the elements live in the inline buffer.
+ * @return true if pArray points at inlineBuffer, false if it points at a dynamic array.
+ */
+bool NumList::isInline() const {
+    return pArray == inlineBuffer;
+}
+
+/**
+ * Moves the elements into a dynamic array of the given capacity.
+ * @param newCapacity The capacity of the new array; must be at least the number of used slots.
+ */
+void NumList::reallocate(int newCapacity) {
+    // Allocate the new array
+    int* newArray = new int[newCapacity];
+    // Copy the elements to the new array
+    std::copy(pArray, pArray + usedSlots(), newArray);
+    // Free the old array, unless it was the inline buffer
+    if (!isInline()) {
+        delete[] pArray;
+    }
+    // Update pArray and capacity
+    pArray = newArray;
+    capacity = newCapacity;
+}
+
+/**
+ * Returns the storage as bytes, for the compressed mode.
+ * @return A pointer to the first byte of pArray.
+ */
+unsigned char* NumList::bytes() {
+    return reinterpret_cast<unsigned char*>(pArray);
+}
+
+/**
+ * Returns the storage as bytes, for the compressed mode.
+ * @return A pointer to the first byte of pArray.
+ */
+const unsigned char* NumList::bytes() const {
+    return reinterpret_cast<const unsigned char*>(pArray);
+}
+
+/**
+ * Returns the number of int slots of pArray that hold data.
+ * @return size in plain mode, or the number of slots covered by byteSize in compressed mode.
+ */
+int NumList::usedSlots() const {
+    return compressed ? (byteSize + 3) / 4 : size;
+}
+
+/**
+ * Grows the storage, doubling the capacity, until it can hold the given number of int slots.
+ * @param slots The number of slots needed.
+ */
+void NumList::reserveSlots(int slots) {
+    if (slots <= capacity) {
+        return;
+    }
+    int newCapacity = capacity;
+    while (newCapacity < slots) {
+        newCapacity *= 2;
+    }
+    reallocate(newCapacity);
+}
+
+/**
+ * Copies the data and mode of another list into this list's (already large enough) storage.
+ * If this list has just taken over the other list's array, only the bookkeeping is copied.
+ * @param other The list to copy from.
+ */
+void NumList::copyContents(const NumList& other) {
+    if (pArray != other.pArray) {
+        std::copy(other.pArray, other.pArray + other.usedSlots(), pArray);
+    }
+    size = other.size;
+    byteSize = other.byteSize;
+    lastValue = other.lastValue;
+    compressed = other.compressed;
+}
+
 /**
  * Overloads the insertion operator to print the elements of the list to an output stream.
  * @param out The output stream to write to.
@@ -205,3 +957,29 @@ std::ostream& operator<<(std::ostream& out, const NumList& list) {
     return out;
 }
 
+/**
+ * Returns the elements as one contiguous array, decoding them into scratch storage in compressed mode.
+ * @param scratch Storage for the decoded elements; only used in compressed mode.
+ * @return A pointer to getSize() elements.
+ */
+const int* NumList::contiguous(std::vector<int>& scratch) const {
+    if (!compressed) {
+        return pArray;
+    }
+    scratch.resize(size);
+    copyTo(scratch.data());
+    return scratch.data();
+}
+
+/**
+ * Creates a plain list holding a copy of an array of elements.
+ * @param values The elements.
+ * @return The new list.
+ */
+NumList NumList::fromValues(const std::vector<int>& values) {
+    NumList list;
+    list.reserveSlots(static_cast<int>(values.size()));
+    std::copy(values.begin(), values.end(), list.pArray);
+    list.size = static_cast<int>(values.size());
+    return list;
+}
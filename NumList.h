@@ -1,23 +1,128 @@
 #ifndef NUMLIST_H
 #define NUMLIST_H
 #pragma once
+#include <cstddef>
 #include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+class OutputBuffer;
 
 /**
  * Class for managing a dynamic array of integers.
+ * The first few elements are stored inside the object itself; the list only allocates once it grows past them.
+ * A list can also be switched to a compressed mode, where each element is stored as the varint-encoded
+ * (zigzag) difference from the previous one. Sorted lists of line numbers mostly need one byte per element
+ * that way. Compressed elements are decoded on the fly; get() then has to walk from the front.
  * The class provides various methods for manipulating and accessing the elements of the array.
  */
 class NumList {
 private:
-    int* pArray;  // a pointer to the dynamic array
+    static constexpr int kInlineCapacity = 4; // Number of elements stored inside the object before spilling to the heap.
+
+    int* pArray;  // a pointer to the elements: either inlineBuffer or a dynamic array
 
     int capacity; // The maximum number of elements that pArray can currently hold.
 
     int size;     // The actual number of elements currently in pArray.
 
+    int inlineBuffer[kInlineCapacity]; // Storage for the first few elements, so short lists need no heap block.
+
+    int byteSize; // In compressed mode, the number of bytes of pArray holding encoded elements.
+
+    int lastValue; // In compressed mode, the last element, which the next one is encoded against.
+
+    bool compressed; // Whether the elements are stored delta + varint encoded.
+
+    static constexpr int kMaxVarintBytes = 5; // The longest encoding of one 32-bit element.
+
+    /**
+     * Returns the storage as bytes, for the compressed mode.
+     * @return A pointer to the first byte of pArray.
+     */
+    unsigned char* bytes();
+
+    /**
+     * Returns the storage as bytes, for the compressed mode.
+     * @return A pointer to the first byte of pArray.
+     */
+    const unsigned char* bytes() const;
+
+    /**
+     * Returns the number of int slots of pArray that hold data.
+     * @return size in plain mode, or the number of slots covered by byteSize in compressed mode.
+     */
+    int usedSlots() const;
+
+    /**
+     * Grows the storage until it can hold the given number of int slots.
+     * @param slots The number of slots needed.
+     */
+    void reserveSlots(int slots);
+
+    /**
+     * Copies the data and mode of another list into this list's (already large enough) storage.
+     * @param other The list to copy from.
+     */
+    void copyContents(const NumList& other);
+
+    /**
+     * Checks whether the elements live in the inline buffer.
+     * @return true if pArray points at inlineBuffer, false if it points at a dynamic array.
+     */
+    bool isInline() const;
+
+    /**
+     * Moves the elements into a dynamic array of the given capacity.
+     * @param newCapacity The capacity of the new array; must be at least size.
+     */
+    void reallocate(int newCapacity);
+
+    /**
+     * Returns the elements as one contiguous array, decoding them into scratch storage in compressed mode.
+     * @param scratch Storage for the decoded elements; only used in compressed mode.
+     * @return A pointer to getSize() elements.
+     */
+    const int* contiguous(std::vector<int>& scratch) const;
+
+    /**
+     * Creates a plain list holding a copy of an array of elements.
+     * @param values The elements.
+     * @return The new list.
+     */
+    static NumList fromValues(const std::vector<int>& values);
+
 public:
     /**
-     * Default constructor. Initializes an empty list.
+     * Forward iterator over the elements of a NumList, decoding compressed elements on the fly.
+     */
+    class const_iterator {
+    private:
+        const NumList* list;
+        int index;
+        const unsigned char* cursor; // Next encoded byte in compressed mode.
+        int value;
+        void load();
+        friend class NumList;
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = int;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const int*;
+        using reference = const int&;
+
+        const_iterator() : list(nullptr), index(0), cursor(nullptr), value(0) {}
+        const int& operator*() const { return value; }
+        const int* operator->() const { return &value; }
+        const_iterator& operator++() { ++index; load(); return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++*this; return old; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+    };
+
+    /**
+     * Default constructor. Initializes an empty list that uses the inline buffer.
      */
     NumList();
 
@@ -59,7 +164,7 @@ public:
     bool empty() const;
 
     /**
-     * Checks if the list is full.
+     * Checks if the list is full, i.e. the next append needs to expand it.
      * @return true if the list is full, false otherwise.
      */
     bool full() const;
@@ -88,12 +193,72 @@ public:
      */
     bool contains(int x) const;
 
+    /**
+     * Computes the distinct values that occur in both of two sorted lists, such as the lines two words share.
+     * Lists of very different lengths are intersected by galloping (exponential) search through the longer
+     * one; lists of similar length are compared four elements against four at a time with SSE2 where available.
+     * @param a The first list, in non-decreasing order.
+     * @param b The second list, in non-decreasing order.
+     * @return A plain list of the common values, in increasing order without repeats.
+     */
+    static NumList intersectionOf(const NumList& a, const NumList& b);
+
+    /**
+     * Computes the distinct values that occur in every one of several sorted lists.
+     * The lists are intersected from the shortest up, stopping as soon as the result is empty.
+     * @param lists The lists, each in non-decreasing order.
+     * @return A plain list of the common values, in increasing order without repeats (empty if lists is empty).
+     */
+    static NumList intersectionOf(const std::vector<const NumList*>& lists);
+
+    /**
+     * Computes the distinct values that occur in either of two sorted lists.
+     * @param a The first list, in non-decreasing order.
+     * @param b The second list, in non-decreasing order.
+     * @return A plain list of all values, in increasing order without repeats.
+     */
+    static NumList unionOf(const NumList& a, const NumList& b);
+
+    /**
+     * Computes the distinct values that occur in any of several sorted lists, merging them pairwise in a tree.
+     * @param lists The lists, each in non-decreasing order.
+     * @return A plain list of all values, in increasing order without repeats.
+     */
+    static NumList unionOf(const std::vector<const NumList*>& lists);
+
+    /**
+     * Intersection operator (see intersectionOf).
+     * @param other The list to intersect with.
+     * @return The distinct values in both lists.
+     */
+    NumList operator&(const NumList& other) const;
+
+    /**
+     * Union operator (see unionOf).
+     * @param other The list to unite with.
+     * @return The distinct values in either list.
+     */
+    NumList operator|(const NumList& other) const;
+
     /**
      * Appends a value to the end of the list.
      * @param x The value to append.
      */
     void append(int x);
 
+    /**
+     * Appends every value of another list to the end of this list, adding an offset to each one.
+     * @param other The list whose values are appended.
+     * @param offset The amount added to each appended value (default is 0).
+     */
+    void append(const NumList& other, int offset = 0);
+
+    /**
+     * Adds the same amount to every value in the list.
+     * @param delta The amount to add.
+     */
+    void shift(int delta);
+
     /**
      * Prints the list to the output stream.
      * @param out The output stream to print to.
@@ -101,6 +266,12 @@ public:
      */
     void print(std::ostream& out, int indentLevel = 0) const;
 
+    /**
+     * Appends the list to an output buffer, in the same format as print(std::ostream&).
+     * @param out The buffer to append to.
+     */
+    void print(OutputBuffer& out) const;
+
     /**
      * Retrieves the value at a given index.
      * @param index The index to retrieve the value from.
@@ -116,6 +287,61 @@ public:
      * (i.e., if the index is out of range).
      */
     bool get(int index, int& value) const;
+
+    /**
+     * Switches the list to the delta + varint compressed mode. Appends keep encoding from then on.
+     */
+    void compress();
+
+    /**
+     * Switches the list back to storing plain ints.
+     */
+    void decompress();
+
+    /**
+     * Checks whether the list is in compressed mode.
+     * @return true if the elements are stored delta + varint encoded, false otherwise.
+     */
+    bool isCompressed() const;
+
+    /**
+     * Writes every element, decoded, to an array.
+     * @param out The destination; it must have room for getSize() ints.
+     */
+    void copyTo(int* out) const;
+
+    /**
+     * Appends the delta + varint encoding of the elements (the compressed-mode representation) to a string.
+     * @param out The string the encoded bytes are appended to.
+     */
+    void encodeTo(std::string& out) const;
+
+    /**
+     * Replaces the contents of the list with elements given in their delta + varint encoding.
+     * The list is left in compressed mode.
+     * @param data The encoded bytes, as produced by encodeTo.
+     * @param length The number of encoded bytes.
+     * @param count The number of elements encoded in data.
+     */
+    void assignEncoded(const unsigned char* data, int length, int count);
+
+    /**
+     * Returns the number of heap bytes used for the elements.
+     * @return 0 while the elements fit inline, otherwise the size of the dynamic array.
+     */
+    size_t heapBytes() const;
+
+    /**
+     * Returns an iterator to the first element.
+     * @return An iterator to the first element.
+     */
+    const_iterator begin() const;
+
+    /**
+     * Returns an iterator past the last element.
+     * @return An iterator past the last element.
+     */
+    const_iterator end() const;
 };
 
 #endif // NUMLIST_H  // End of the inclusion guard
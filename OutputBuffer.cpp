@@ -0,0 +1,36 @@
+#include <charconv>
+#include "OutputBuffer.h"
+
+/**
+ * Constructor that buffers output for a stream.
+ * @param out The output stream to write to.
+ * @param capacity The size of the buffer in bytes.
+ */
+OutputBuffer::OutputBuffer(std::ostream& out, size_t capacity) : out(out), buffer(capacity < 16 ? 16 : capacity) {}
+
+/**
+ * Destructor. Writes out whatever is still buffered.
+ */
+OutputBuffer::~OutputBuffer() {
+    flush();
+}
+
+/**
+ * Appends the decimal text of an integer, formatted exactly as operator<< does in the "C" locale.
+ * @param value The integer to append.
+ */
+void OutputBuffer::append(int value) {
+    reserve(11); // "-2147483648"
+    char* start = buffer.data() + used;
+    used = std::to_chars(start, start + 11, value).ptr - buffer.data();
+}
+
+/**
+ * Writes the buffered text to the stream and empties the buffer.
+ */
+void OutputBuffer::flush() {
+    if (used != 0) {
+        out.write(buffer.data(), static_cast<std::streamsize>(used));
+        used = 0;
+    }
+}
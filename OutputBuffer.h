@@ -0,0 +1,88 @@
+#ifndef OUTPUTBUFFER_H_
+#define OUTPUTBUFFER_H_
+#include <cstddef>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+/**
+ * The OutputBuffer class collects formatted text in a large reusable buffer and writes it to an output stream
+ * in big chunks, so printing millions of line numbers does not go through operator<< once per number.
+ */
+class OutputBuffer {
+private:
+    /** The stream the buffered text is written to */
+    std::ostream& out;
+
+    /** The buffered text */
+    std::vector<char> buffer;
+
+    /** Number of bytes of buffer in use */
+    size_t used{ 0 };
+
+    /**
+     * Makes room for at least a given number of bytes, flushing the buffer if needed.
+     * @param bytes The number of bytes about to be appended.
+     */
+    void reserve(size_t bytes) {
+        if (buffer.size() - used < bytes) {
+            flush();
+        }
+    }
+
+public:
+    /** The default buffer size in bytes */
+    static constexpr size_t kDefaultCapacity = 1 << 20;
+
+    /**
+     * Constructor that buffers output for a stream.
+     * @param out The output stream to write to.
+     * @param capacity The size of the buffer in bytes.
+     */
+    explicit OutputBuffer(std::ostream& out, size_t capacity = kDefaultCapacity);
+
+    /**
+     * Destructor. Writes out whatever is still buffered.
+     */
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+
+    /**
+     * Appends a sequence of characters.
+     * @param text The characters to append.
+     */
+    void append(std::string_view text) {
+        if (text.size() > buffer.size()) {
+            flush();
+            out.write(text.data(), static_cast<std::streamsize>(text.size()));
+            return;
+        }
+        reserve(text.size());
+        text.copy(buffer.data() + used, text.size());
+        used += text.size();
+    }
+
+    /**
+     * Appends a single character.
+     * @param c The character to append.
+     */
+    void append(char c) {
+        reserve(1);
+        buffer[used++] = c;
+    }
+
+    /**
+     * Appends the decimal text of an integer, formatted exactly as operator<< does in the "C" locale.
+     * @param value The integer to append.
+     */
+    void append(int value);
+
+    /**
+     * Writes the buffered text to the stream and empties the buffer.
+     */
+    void flush();
+};
+
+#endif /* OUTPUTBUFFER_H_ */
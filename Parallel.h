@@ -0,0 +1,70 @@
+#ifndef PARALLEL_H_
+#define PARALLEL_H_
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Returns the number of worker threads to use for a requested thread count.
+ * @param threads The requested number of threads, or 0 for one per hardware thread.
+ * @return The number of threads to use (at least 1).
+ */
+inline unsigned workerCount(unsigned threads) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    return std::max(threads, 1u);
+}
+
+/**
+ * Calls task(i) for every i in [0, count) using up to the given number of threads.
+ * Indices are handed out dynamically, so uneven tasks balance across the threads.
+ * The first exception thrown by a task is rethrown on the calling thread once all threads have finished.
+ * @param threads The number of threads to use, or 0 for one per hardware thread.
+ * @param count The number of tasks.
+ * @param task The callable to run for each index.
+ */
+template <typename Task>
+void parallelFor(unsigned threads, size_t count, Task task) {
+    size_t workers = std::min<size_t>(workerCount(threads), count);
+    if (workers <= 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextIndex{ 0 };
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+    auto worker = [&]() {
+        try {
+            for (size_t i = nextIndex++; i < count; i = nextIndex++) {
+                task(i);
+            }
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failureMutex);
+            if (!failure) {
+                failure = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < workers; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker(); // The calling thread works too
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+#endif /* PARALLEL_H_ */
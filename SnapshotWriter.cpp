@@ -0,0 +1,93 @@
+#include <cstring>
+#include <stdexcept>
+#include "SnapshotWriter.h"
+
+/**
+ * Constructor that creates (or truncates) the snapshot file and reserves room for the header.
+ * @param path The name of the file to write.
+ * @throws std::runtime_error If the file cannot be created.
+ */
+SnapshotWriter::SnapshotWriter(const std::string& path)
+        : fout(path, std::ios::binary | std::ios::trunc), path(path), position(sizeof(Header)) {
+    if (!fout) {
+        throw std::runtime_error("could not create snapshot file: " + path);
+    }
+    // The real header is written by finish(), once the counts are known
+    Header placeholder{};
+    fout.write(reinterpret_cast<const char*>(&placeholder), sizeof(placeholder));
+}
+
+/**
+ * Destructor. Finishes the file if finish() was not called.
+ */
+SnapshotWriter::~SnapshotWriter() {
+    if (!finished) {
+        try {
+            finish();
+        } catch (...) {
+            // Destructors must not throw; call finish() to see write errors
+        }
+    }
+}
+
+/**
+ * Appends the record of one word.
+ * @param word The characters of the word.
+ * @param frequency The number of occurrences of the word.
+ * @param lines The line numbers of the word.
+ */
+void SnapshotWriter::add(std::string_view word, int frequency, const NumList& lines) {
+    encoded.clear();
+    lines.encodeTo(encoded);
+    add(word, frequency, lines.getSize(), encoded);
+}
+
+/**
+ * Appends the record of one word whose line numbers are already encoded.
+ * @param word The characters of the word.
+ * @param frequency The number of occurrences of the word.
+ * @param count The number of line numbers.
+ * @param encodedLines The line numbers, delta + varint encoded as in NumList::compress.
+ */
+void SnapshotWriter::add(std::string_view word, int frequency, int count, std::string_view encodedLines) {
+    RecordHeader record;
+    record.length = static_cast<uint32_t>(word.size());
+    record.frequency = static_cast<uint32_t>(frequency);
+    record.count = static_cast<uint32_t>(count);
+    record.encodedBytes = static_cast<uint32_t>(encodedLines.size());
+    fout.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    fout.write(word.data(), word.size());
+    fout.write(encodedLines.data(), encodedLines.size());
+    offsets.push_back(position);
+    position += sizeof(record) + word.size() + encodedLines.size();
+}
+
+/**
+ * Writes the index and the final header and closes the file.
+ * @throws std::runtime_error If writing failed.
+ */
+void SnapshotWriter::finish() {
+    if (finished) {
+        return;
+    }
+    finished = true;
+
+    // Align the index so it can be read in place from the mapping
+    static const char padding[8] = {};
+    uint64_t indexOffset = (position + 7) & ~uint64_t(7);
+    fout.write(padding, indexOffset - position);
+    fout.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+
+    Header header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.byteOrder = kByteOrderMark;
+    header.version = kVersion;
+    header.wordCount = offsets.size();
+    header.indexOffset = indexOffset;
+    fout.seekp(0);
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.close();
+    if (!fout) {
+        throw std::runtime_error("could not write snapshot file: " + path);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef SNAPSHOTWRITER_H_
+#define SNAPSHOTWRITER_H_
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "NumList.h"
+
+/**
+ * The SnapshotWriter class writes a dictionary snapshot file one word at a time.
+ * Words must be added in the order Dictionary::print lists them (see Dictionary::compareOrder).
+ *
+ * File layout (native byte order, checked on load):
+ *   header   magic "TXTDICT1", byte-order mark, version, word count, offset of the index
+ *   records  per word: length, frequency, line count, encoded-lines length (four uint32),
+ *            the word's characters, then its line numbers delta + varint encoded as in NumList::compress
+ *   index    one uint64 file offset per record, in word order, 8-byte aligned
+ */
+class SnapshotWriter {
+public:
+    /** Layout of the fixed-size header at the start of a snapshot file */
+    struct Header {
+        char magic[8];
+        uint32_t byteOrder;
+        uint32_t version;
+        uint64_t wordCount;
+        uint64_t indexOffset;
+    };
+
+    /** Layout of the fixed-size part of a record */
+    struct RecordHeader {
+        uint32_t length;
+        uint32_t frequency;
+        uint32_t count;
+        uint32_t encodedBytes;
+    };
+
+    /** The magic bytes a snapshot file starts with */
+    static constexpr char kMagic[8] = { 'T', 'X', 'T', 'D', 'I', 'C', 'T', '1' };
+
+    /** Written as a uint32 so a file from a machine with the other byte order is recognised */
+    static constexpr uint32_t kByteOrderMark = 0x01020304u;
+
+    /** The current format version */
+    static constexpr uint32_t kVersion = 1;
+
+private:
+    /** The file being written */
+    std::ofstream fout;
+
+    /** The name of the file being written */
+    std::string path;
+
+    /** Offset of every record written so far */
+    std::vector<uint64_t> offsets;
+
+    /** Offset the next record is written at */
+    uint64_t position;
+
+    /** Scratch buffer for encoding line numbers */
+    std::string encoded;
+
+    /** Whether finish() has been called */
+    bool finished{ false };
+
+public:
+    /**
+     * Constructor that creates (or truncates) the snapshot file and reserves room for the header.
+     * @param path The name of the file to write.
+     * @throws std::runtime_error If the file cannot be created.
+     */
+    explicit SnapshotWriter(const std::string& path);
+
+    /**
+     * Destructor. Finishes the file if finish() was not called.
+     */
+    ~SnapshotWriter();
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    /**
+     * Appends the record of one word.
+     * @param word The characters of the word.
+     * @param frequency The number of occurrences of the word.
+     * @param lines The line numbers of the word.
+     */
+    void add(std::string_view word, int frequency, const NumList& lines);
+
+    /**
+     * Appends the record of one word whose line numbers are already encoded.
+     * @param word The characters of the word.
+     * @param frequency The number of occurrences of the word.
+     * @param count The number of line numbers.
+     * @param encodedLines The line numbers, delta + varint encoded as in NumList::compress.
+     */
+    void add(std::string_view word, int frequency, int count, std::string_view encodedLines);
+
+    /**
+     * Writes the index and the final header and closes the file.
+     * @throws std::runtime_error If writing failed.
+     */
+    void finish();
+};
+
+#endif /* SNAPSHOTWRITER_H_ */
@@ -0,0 +1,117 @@
+#include <cstdio>
+#include <stdexcept>
+#include <stdlib.h>
+#include <unistd.h>
+#include "SpillRun.h"
+
+/**
+ * Constructor that creates an empty run in a new temporary file.
+ * @param directory The directory to create the file in.
+ * @throws std::runtime_error If the file cannot be created.
+ */
+SpillRun::SpillRun(const std::string& directory) : path(directory + "/textdict-run-XXXXXX") {
+    // mkstemp picks a name no other run or process is using and creates the file
+    int fd = mkstemp(&path[0]);
+    if (fd < 0) {
+        throw std::runtime_error("could not create spill file in: " + directory);
+    }
+    close(fd);
+    file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::remove(path.c_str());
+        throw std::runtime_error("could not open spill file: " + path);
+    }
+}
+
+/**
+ * Destructor. Closes and removes the temporary file.
+ */
+SpillRun::~SpillRun() {
+    file.close();
+    std::remove(path.c_str());
+}
+
+/**
+ * Appends the record of one word.
+ * @param word The characters of the word.
+ * @param count The number of line numbers.
+ * @param encodedLines The line numbers, delta + varint encoded.
+ */
+void SpillRun::add(std::string_view word, int count, std::string_view encodedLines) {
+    RecordHeader record;
+    record.length = static_cast<uint32_t>(word.size());
+    record.count = static_cast<uint32_t>(count);
+    record.encodedBytes = static_cast<uint32_t>(encodedLines.size());
+    file.write(reinterpret_cast<const char*>(&record), sizeof(record));
+    file.write(word.data(), word.size());
+    file.write(encodedLines.data(), encodedLines.size());
+    ++records;
+}
+
+/**
+ * Returns the number of records written to the run.
+ * @return The number of words in the run.
+ */
+size_t SpillRun::size() const {
+    return records;
+}
+
+/**
+ * Ends writing and positions the run before its first record.
+ * @throws std::runtime_error If writing the run failed.
+ */
+void SpillRun::rewind() {
+    file.flush();
+    if (!file) {
+        throw std::runtime_error("could not write spill file: " + path);
+    }
+    file.seekg(0);
+}
+
+/**
+ * Reads the next record.
+ * @return true if a record was read, false at the end of the run.
+ * @throws std::runtime_error If the run is truncated.
+ */
+bool SpillRun::next() {
+    RecordHeader record;
+    if (!file.read(reinterpret_cast<char*>(&record), sizeof(record))) {
+        if (file.gcount() != 0) {
+            throw std::runtime_error("truncated spill file: " + path);
+        }
+        return false;
+    }
+    currentWord.resize(record.length);
+    currentLines.resize(record.encodedBytes);
+    file.read(&currentWord[0], record.length);
+    file.read(&currentLines[0], record.encodedBytes);
+    if (!file) {
+        throw std::runtime_error("truncated spill file: " + path);
+    }
+    currentCount = static_cast<int>(record.count);
+    return true;
+}
+
+/**
+ * Returns the characters of the current record.
+ * @return The word.
+ */
+std::string_view SpillRun::word() const {
+    return currentWord;
+}
+
+/**
+ * Returns the number of line numbers of the current record.
+ * @return The number of line numbers.
+ */
+int SpillRun::count() const {
+    return currentCount;
+}
+
+/**
+ * Returns the line numbers of the current record.
+ * @return The line numbers delta + varint encoded.
+ */
+std::string_view SpillRun::encodedLines() const {
+    return currentLines;
+}
@@ -0,0 +1,113 @@
+#ifndef SPILLRUN_H_
+#define SPILLRUN_H_
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+/**
+ * The SpillRun class is one sorted run of an external-memory build: a temporary file of word records that is
+ * written once, in print order (see Dictionary::compareOrder), and then read back one record at a time.
+ *
+ * Record layout (native byte order, the file never leaves the machine):
+ *   length, line count, encoded-lines length (three uint32), the word's characters,
+ *   then its line numbers delta + varint encoded as in NumList::compress
+ *
+ * Reading goes through a buffered stream, so merging many runs needs only a small buffer per run.
+ * The file is removed when the SpillRun is destroyed.
+ */
+class SpillRun {
+public:
+    /** The most runs merged in one pass; more runs are merged in several passes */
+    static constexpr size_t kMaxFanIn = 64;
+
+private:
+    /** Layout of the fixed-size part of a record */
+    struct RecordHeader {
+        uint32_t length;
+        uint32_t count;
+        uint32_t encodedBytes;
+    };
+
+    /** The name of the temporary file */
+    std::string path;
+
+    /** The temporary file, open for writing until rewind() and for reading after */
+    std::fstream file;
+
+    /** The number of records written */
+    size_t records{ 0 };
+
+    /** The characters of the current record */
+    std::string currentWord;
+
+    /** The number of line numbers of the current record */
+    int currentCount{ 0 };
+
+    /** The encoded line numbers of the current record */
+    std::string currentLines;
+
+public:
+    /**
+     * Constructor that creates an empty run in a new temporary file.
+     * @param directory The directory to create the file in.
+     * @throws std::runtime_error If the file cannot be created.
+     */
+    explicit SpillRun(const std::string& directory);
+
+    /**
+     * Destructor. Closes and removes the temporary file.
+     */
+    ~SpillRun();
+
+    SpillRun(const SpillRun&) = delete;
+    SpillRun& operator=(const SpillRun&) = delete;
+
+    /**
+     * Appends the record of one word. Words must be added in print order, each at most once.
+     * @param word The characters of the word.
+     * @param count The number of line numbers.
+     * @param encodedLines The line numbers, delta + varint encoded as in NumList::compress.
+     */
+    void add(std::string_view word, int count, std::string_view encodedLines);
+
+    /**
+     * Returns the number of records written to the run.
+     * @return The number of words in the run.
+     */
+    size_t size() const;
+
+    /**
+     * Ends writing and positions the run before its first record; call next() to read it.
+     * @throws std::runtime_error If writing the run failed.
+     */
+    void rewind();
+
+    /**
+     * Reads the next record.
+     * @return true if a record was read, false at the end of the run.
+     * @throws std::runtime_error If the run is truncated.
+     */
+    bool next();
+
+    /**
+     * Returns the characters of the current record.
+     * @return The word, valid until the next call to next().
+     */
+    std::string_view word() const;
+
+    /**
+     * Returns the number of line numbers of the current record.
+     * @return The number of line numbers, which is also the frequency of the word.
+     */
+    int count() const;
+
+    /**
+     * Returns the line numbers of the current record.
+     * @return The line numbers delta + varint encoded, valid until the next call to next().
+     */
+    std::string_view encodedLines() const;
+};
+
+#endif /* SPILLRUN_H_ */
@@ -0,0 +1,151 @@
+#include "Tokenizer.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define TOKENIZER_X86 1
+#if defined(__GNUC__) || defined(__clang__)
+#define TOKENIZER_AVX2 1
+#endif
+#endif
+
+/**
+ * Classifies blocks one byte at a time. Used where no vector instructions are available.
+ * @param data The bytes to classify.
+ * @param blocks The number of blocks.
+ * @param separators Receives the whitespace mask of every block.
+ * @param newlines Receives the line-break mask of every block.
+ */
+static void classifyScalar(const char* data, size_t blocks, uint64_t* separators, uint64_t* newlines) {
+    for (size_t b = 0; b < blocks; ++b, data += Tokenizer::kBlockSize) {
+        uint64_t space = 0;
+        uint64_t newline = 0;
+        for (size_t i = 0; i < Tokenizer::kBlockSize; ++i) {
+            space |= uint64_t(Tokenizer::isSeparator(data[i])) << i;
+            newline |= uint64_t(data[i] == '\n') << i;
+        }
+        separators[b] = space;
+        newlines[b] = newline;
+    }
+}
+
+#ifdef TOKENIZER_X86
+/**
+ * Classifies blocks 16 bytes at a time with SSE2.
+ * A byte c is whitespace if c == ' ' or c - '\t' <= 4 (unsigned), tested with a saturating minimum.
+ * @param data The bytes to classify.
+ * @param blocks The number of blocks.
+ * @param separators Receives the whitespace mask of every block.
+ * @param newlines Receives the line-break mask of every block.
+ */
+static void classifySse2(const char* data, size_t blocks, uint64_t* separators, uint64_t* newlines) {
+    const __m128i space = _mm_set1_epi8(' ');
+    const __m128i tab = _mm_set1_epi8('\t');
+    const __m128i four = _mm_set1_epi8(4);
+    const __m128i newline = _mm_set1_epi8('\n');
+    for (size_t b = 0; b < blocks; ++b, data += Tokenizer::kBlockSize) {
+        uint64_t spaceMask = 0;
+        uint64_t newlineMask = 0;
+        for (int part = 0; part < 4; ++part) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + part * 16));
+            __m128i offset = _mm_sub_epi8(bytes, tab);
+            __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(offset, four), offset);
+            __m128i isSpace = _mm_or_si128(control, _mm_cmpeq_epi8(bytes, space));
+            spaceMask |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(isSpace))) << (part * 16);
+            newlineMask |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline))))
+                           << (part * 16);
+        }
+        separators[b] = spaceMask;
+        newlines[b] = newlineMask;
+    }
+}
+#endif
+
+#ifdef TOKENIZER_AVX2
+/**
+ * Classifies blocks 32 bytes at a time with AVX2, the same way as classifySse2.
+ * Compiled for AVX2 regardless of the build flags and only called after checking the CPU supports it.
+ * @param data The bytes to classify.
+ * @param blocks The number of blocks.
+ * @param separators Receives the whitespace mask of every block.
+ * @param newlines Receives the line-break mask of every block.
+ */
+__attribute__((target("avx2")))
+static void classifyAvx2(const char* data, size_t blocks, uint64_t* separators, uint64_t* newlines) {
+    const __m256i space = _mm256_set1_epi8(' ');
+    const __m256i tab = _mm256_set1_epi8('\t');
+    const __m256i four = _mm256_set1_epi8(4);
+    const __m256i newline = _mm256_set1_epi8('\n');
+    for (size_t b = 0; b < blocks; ++b, data += Tokenizer::kBlockSize) {
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32));
+        __m256i lowOffset = _mm256_sub_epi8(low, tab);
+        __m256i highOffset = _mm256_sub_epi8(high, tab);
+        __m256i lowSpace = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(lowOffset, four), lowOffset),
+                                           _mm256_cmpeq_epi8(low, space));
+        __m256i highSpace = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_min_epu8(highOffset, four), highOffset),
+                                            _mm256_cmpeq_epi8(high, space));
+        separators[b] = uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(lowSpace))) |
+                        uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(highSpace))) << 32;
+        newlines[b] = uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newline)))) |
+                      uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newline)))) << 32;
+    }
+}
+#endif
+
+using Classifier = void (*)(const char*, size_t, uint64_t*, uint64_t*);
+
+/**
+ * Picks the fastest classifier the CPU supports.
+ * @return The classifier.
+ */
+static Classifier selectClassifier() {
+#ifdef TOKENIZER_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return classifyAvx2;
+    }
+#endif
+#ifdef TOKENIZER_X86
+    return classifySse2;
+#else
+    return classifyScalar;
+#endif
+}
+
+/**
+ * Returns the classifier chosen for this machine, picked on first use.
+ * @return The classifier.
+ */
+static Classifier classifier() {
+    static const Classifier selected = selectClassifier();
+    return selected;
+}
+
+/**
+ * Classifies a run of whole blocks.
+ * @param data The bytes to classify, blocks * kBlockSize of them.
+ * @param blocks The number of blocks.
+ * @param separators Receives one mask per block; bit i is set if byte i of the block is whitespace.
+ * @param newlines Receives one mask per block; bit i is set if byte i of the block is '\n'.
+ */
+void Tokenizer::classify(const char* data, size_t blocks, uint64_t* separators, uint64_t* newlines) {
+    classifier()(data, blocks, separators, newlines);
+}
+
+/**
+ * Returns the name of the classifier classify() uses on this machine.
+ * @return "avx2", "sse2" or "scalar".
+ */
+const char* Tokenizer::implementation() {
+    Classifier selected = classifier();
+#ifdef TOKENIZER_AVX2
+    if (selected == classifyAvx2) {
+        return "avx2";
+    }
+#endif
+#ifdef TOKENIZER_X86
+    if (selected == classifySse2) {
+        return "sse2";
+    }
+#endif
+    return selected == classifyScalar ? "scalar" : "unknown";
+}
@@ -0,0 +1,159 @@
+#ifndef TOKENIZER_H_
+#define TOKENIZER_H_
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+/**
+ * The Tokenizer class splits text into whitespace-separated words 64 bytes at a time.
+ * Each block is classified with SIMD compares (AVX2 when the CPU supports it, otherwise SSE2, otherwise a
+ * scalar loop) into a bitmask of separator bytes and a bitmask of line breaks. Word boundaries are then found
+ * with bit operations on the masks, and line numbers come from counting the line-break bits, so the text is
+ * only read once. Whitespace is the set operator>> skips in the "C" locale: ' ', '\t', '\n', '\v', '\f', '\r'.
+ */
+class Tokenizer {
+public:
+    /** Number of bytes classified per mask */
+    static constexpr size_t kBlockSize = 64;
+
+    /**
+     * Classifies a run of whole blocks.
+     * @param data The bytes to classify, blocks * kBlockSize of them.
+     * @param blocks The number of blocks.
+     * @param separators Receives one mask per block; bit i is set if byte i of the block is whitespace.
+     * @param newlines Receives one mask per block; bit i is set if byte i of the block is '\n'.
+     */
+    static void classify(const char* data, size_t blocks, uint64_t* separators, uint64_t* newlines);
+
+    /**
+     * Returns the name of the classifier classify() uses on this machine.
+     * @return "avx2", "sse2" or "scalar".
+     */
+    static const char* implementation();
+
+    /**
+     * Checks for the characters the Tokenizer treats as whitespace.
+     * @param c The character to check.
+     * @return true if c separates words.
+     */
+    static bool isSeparator(char c) {
+        return c == ' ' || (c >= '\t' && c <= '\r');
+    }
+
+    /**
+     * Calls visit(word, linenum) for every word in the text, in order.
+     * @param text The text to split. Lines are separated by '\n'.
+     * @param linenum The line number of the first line in text.
+     * @param visit The callable receiving a std::string_view into text and the word's line number.
+     * @return The line number the text following this block would start on.
+     */
+    template <typename Visitor>
+    static int forEachWord(std::string_view text, int linenum, Visitor&& visit);
+
+private:
+    /** Number of blocks classified per call to classify() by forEachWord */
+    static constexpr size_t kBatchBlocks = 64;
+
+    /**
+     * Returns the position of the lowest set bit of a non-zero mask.
+     * @param mask The mask.
+     * @return The index of its lowest set bit.
+     */
+    static unsigned lowestBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<unsigned>(__builtin_ctzll(mask));
+#else
+        unsigned index = 0;
+        while ((mask & 1) == 0) {
+            mask >>= 1;
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    /**
+     * Returns the number of set bits of a mask.
+     * @param mask The mask.
+     * @return The number of set bits.
+     */
+    static int countBits(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(mask);
+#else
+        int count = 0;
+        for (; mask != 0; mask &= mask - 1) {
+            ++count;
+        }
+        return count;
+#endif
+    }
+};
+
+/**
+ * Calls visit(word, linenum) for every word in the text, in order.
+ * @param text The text to split. Lines are separated by '\n'.
+ * @param linenum The line number of the first line in text.
+ * @param visit The callable receiving a std::string_view into text and the word's line number.
+ * @return The line number the text following this block would start on.
+ */
+template <typename Visitor>
+int Tokenizer::forEachWord(std::string_view text, int linenum, Visitor&& visit) {
+    uint64_t separators[kBatchBlocks];
+    uint64_t newlines[kBatchBlocks];
+    const char* base = text.data();
+    size_t length = text.size();
+    size_t wholeBlocks = length / kBlockSize;
+
+    const char* wordStart = nullptr; // Start of the word running into the current block, if any
+    int wordLine = linenum;
+    uint64_t previousInWord = 0;     // 1 if the last byte of the previous block was part of a word
+
+    for (size_t first = 0; first * kBlockSize < length; first += kBatchBlocks) {
+        size_t batch = 0;
+        if (first < wholeBlocks) {
+            batch = wholeBlocks - first < kBatchBlocks ? wholeBlocks - first : kBatchBlocks;
+            classify(base + first * kBlockSize, batch, separators, newlines);
+        }
+        if (batch < kBatchBlocks && first + batch == wholeBlocks && wholeBlocks * kBlockSize < length) {
+            // The partial last block, padded with spaces so a word at the end of the text is closed
+            char tail[kBlockSize];
+            size_t rest = length - wholeBlocks * kBlockSize;
+            std::memset(tail, ' ', kBlockSize);
+            std::memcpy(tail, base + wholeBlocks * kBlockSize, rest);
+            classify(tail, 1, separators + batch, newlines + batch);
+            ++batch;
+        }
+
+        for (size_t b = 0; b < batch; ++b) {
+            const char* block = base + (first + b) * kBlockSize;
+            uint64_t inWord = ~separators[b];
+            uint64_t shifted = (inWord << 1) | previousInWord;
+            uint64_t starts = inWord & ~shifted;
+            uint64_t ends = ~inWord & shifted;
+            uint64_t events = starts | ends;
+            while (events != 0) {
+                unsigned position = lowestBit(events);
+                uint64_t bit = uint64_t(1) << position;
+                if (starts & bit) {
+                    wordStart = block + position;
+                    wordLine = linenum + countBits(newlines[b] & (bit - 1));
+                } else {
+                    visit(std::string_view(wordStart, static_cast<size_t>(block + position - wordStart)), wordLine);
+                }
+                events &= events - 1;
+            }
+            linenum += countBits(newlines[b]);
+            previousInWord = inWord >> 63;
+        }
+    }
+
+    if (previousInWord != 0) {
+        // The text ends exactly at a block boundary in the middle of a word
+        visit(std::string_view(wordStart, static_cast<size_t>(base + length - wordStart)), wordLine);
+    }
+    return linenum;
+}
+
+#endif /* TOKENIZER_H_ */
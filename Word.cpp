@@ -1,4 +1,7 @@
+#include <algorithm>
 #include "Word.h"
+#include "OutputBuffer.h"
+#include "Arena.h"
 
 /**
  * Constructor that creates a new Word using the supplied C-string pChArr and integer n.
@@ -6,21 +9,60 @@
  * @param n An integer associated with the word.
  */
 Word::Word(const char* pChArr, int n) : frequency(1) {
-    // Allocate memory for the character array (C-string)
-    pCharArray = new char[strlen(pChArr) + 1];
-    // Copy the supplied C-string into the allocated memory
-    std::strcpy(pCharArray, pChArr);
+    assignChars(pChArr, nullptr);
     num_list.append(n);
 }
 
+/**
+ * Constructor that creates a new Word from the characters of a string_view and integer n.
+ * @param str The characters of the word.
+ * @param n An integer associated with the word.
+ */
+Word::Word(std::string_view str, int n) : frequency(1) {
+    assignChars(str, nullptr);
+    num_list.append(n);
+}
+
+/**
+ * Constructor that creates a new Word whose characters are copied into an Arena unless they fit inline.
+ * @param str The characters of the word.
+ * @param n An integer associated with the word.
+ * @param arena The Arena that stores the characters.
+ */
+Word::Word(std::string_view str, int n, Arena& arena) : frequency(1) {
+    assignChars(str, &arena);
+    num_list.append(n);
+}
+
+/**
+ * Copy constructor that places the copy's characters in an Arena unless they fit inline.
+ * @param other The Word object to copy.
+ * @param arena The Arena that stores the characters of the copy.
+ */
+Word::Word(const Word& other, Arena& arena) : frequency(other.frequency), num_list(other.num_list) {
+    assignChars(other.view(), &arena);
+}
+
+/**
+ * Move constructor that places the characters in an Arena unless they are inline or owned by other.
+ * Characters that live in another Arena are copied, so the new Word does not depend on that Arena.
+ * @param other The Word object to move resources from.
+ * @param arena The Arena that stores the characters of the new Word.
+ */
+Word::Word(Word&& other, Arena& arena) : frequency(other.frequency), num_list(std::move(other.num_list)) {
+    if (other.pCharArray == other.inlineChars || other.ownsChars) {
+        takeChars(other);
+    } else {
+        assignChars(other.view(), &arena);
+    }
+}
+
 /**
  * Copy constructor that creates a new Word which is a copy of another Word.
  * @param other The Word object to copy.
  */
 Word::Word(const Word& other) : frequency(other.frequency), num_list(other.num_list) {
-    pCharArray = new char[strlen(other.pCharArray) + 1];
-    // Copy the character array from the other Word
-    std::strcpy(pCharArray, other.pCharArray);
+    assignChars(other.view(), nullptr);
 }
 
 /**
@@ -28,9 +70,7 @@ Word::Word(const Word& other) : frequency(other.frequency), num_list(other.num_l
  * @param other The Word object to move resources from.
  */
 Word::Word(Word&& other) noexcept : frequency(other.frequency), num_list(std::move(other.num_list)) {
-    // Move the pointer to the character array from the other Word
-    pCharArray = other.pCharArray;
-    other.pCharArray = nullptr; // Null the source pointer to avoid double deletion
+    takeChars(other);
 }
 
 /**
@@ -40,10 +80,10 @@ Word::Word(Word&& other) noexcept : frequency(other.frequency), num_list(std::mo
  */
 Word& Word::operator=(const Word& other) {
     if (this != &other) {
-        delete[] pCharArray; // Delete existing memory
-        pCharArray = new char[strlen(other.pCharArray) + 1];
-        // Copy the character array from the other Word
-        std::strcpy(pCharArray, other.pCharArray);
+        if (ownsChars) {
+            delete[] pCharArray; // Delete existing memory
+        }
+        assignChars(other.view(), nullptr);
         // Copy the frequency and NumList from the other Word
         frequency = other.frequency;
         num_list = other.num_list;
@@ -58,9 +98,10 @@ Word& Word::operator=(const Word& other) {
  */
 Word& Word::operator=(Word&& other) noexcept {
     if (this != &other) {
-        delete[] pCharArray; // Delete existing memory
-        pCharArray = other.pCharArray;
-        other.pCharArray = nullptr; // Null the source pointer to avoid double deletion
+        if (ownsChars) {
+            delete[] pCharArray; // Delete existing memory
+        }
+        takeChars(other);
         // Move the frequency and NumList from the other Word
         frequency = other.frequency;
         num_list = std::move(other.num_list);
@@ -70,17 +111,12 @@ Word& Word::operator=(Word&& other) noexcept {
 
 /**
  * Destructor that frees the memory allocated for the Word.
+ * Characters that live in an Arena are left for the Arena to release.
  */
 Word::~Word() {
-    delete[] pCharArray;
-}
-
-/**
- * Returns a const pointer to the C-string representation of the Word.
- * @return A const pointer to the character array.
- */
-const char* Word::c_str() const {
-    return pCharArray;
+    if (ownsChars) {
+        delete[] pCharArray;
+    }
 }
 
 /**
@@ -94,11 +130,35 @@ void Word::appendNumber(int n) {
 }
 
 /**
- * Returns the length of the Word's C-string.
- * @return The length of the character array.
+ * Merges the occurrences of another Word into this one.
+ * @param other The Word whose occurrences are merged in.
+ * @param lineOffset The amount added to each of the other Word's numbers.
  */
-size_t Word::size() const {
-    return strlen(pCharArray);
+void Word::merge(const Word& other, int lineOffset) {
+    num_list.append(other.num_list, lineOffset);
+    frequency += other.frequency;
+}
+
+/**
+ * Adds the same amount to every number in the Word's NumList.
+ * @param lineOffset The amount to add.
+ */
+void Word::shiftNumbers(int lineOffset) {
+    num_list.shift(lineOffset);
+}
+
+/**
+ * Switches the Word's NumList to its delta + varint compressed mode.
+ */
+void Word::compressNumbers() {
+    num_list.compress();
+}
+
+/**
+ * Switches the Word's NumList back to plain ints.
+ */
+void Word::decompressNumbers() {
+    num_list.decompress();
 }
 
 /**
@@ -116,6 +176,23 @@ void Word::print(std::ostream& out) const {
     }
 }
 
+/**
+ * Appends the Word's character array and its NumList to an output buffer, in the same format as print(std::ostream&).
+ * @param out The buffer to append to.
+ */
+void Word::print(OutputBuffer& out) const {
+    if (pCharArray != nullptr) {
+        out.append(view());
+        out.append(": ");
+        out.append(frequency);
+        out.append(" times, lines: ");
+        num_list.print(out);
+        out.append('\n');
+    }
+    else {
+        out.append("(empty)\n");
+    }
+}
 
 /**
  * Returns a constant reference to the Word's NumList.
@@ -126,13 +203,54 @@ const NumList& Word::getNumberList() const {
 }
 
 /**
- * Compares this Word's character array to another Word's character array.
+ * Returns the number of occurrences of the Word.
+ * @return The frequency of the Word.
+ */
+int Word::getFrequency() const {
+    return frequency;
+}
 
-Returns -1, 0, or 1, depending on whether this Word's character array is less than, equal to, or greater than the other Word's character array.
-@param other The Word to compare with.
-@return An integer representing the comparison result.
-*/
-int Word::compare(const Word& other) const {
-    return std::strcmp(pCharArray, other.pCharArray);
+/**
+ * Stores a copy of some characters: inside the Word if they fit, otherwise in the Arena or on the heap.
+ * @param str The characters.
+ * @param arena The Arena for long words, or nullptr to use the heap.
+ */
+void Word::assignChars(std::string_view str, Arena* arena) {
+    length = static_cast<uint32_t>(str.size());
+    prefix = prefixOf(str);
+    ownsChars = false;
+    if (str.size() <= kInlineCapacity) {
+        pCharArray = inlineChars;
+        std::memcpy(pCharArray, str.data(), str.size());
+        pCharArray[str.size()] = '\0';
+    } else if (arena != nullptr) {
+        pCharArray = arena->copyString(str);
+    } else {
+        // Allocate memory for the characters plus the terminating null
+        pCharArray = new char[str.size() + 1];
+        ownsChars = true;
+        std::memcpy(pCharArray, str.data(), str.size());
+        pCharArray[str.size()] = '\0';
+    }
 }
 
+/**
+ * Takes over the characters of another Word. Inline characters are copied, others change owner.
+ * The other Word is left with a null character pointer, which print shows as "(empty)".
+ * @param other The Word to take the characters from.
+ */
+void Word::takeChars(Word& other) noexcept {
+    length = other.length;
+    prefix = other.prefix;
+    ownsChars = other.ownsChars;
+    if (other.pCharArray == other.inlineChars) {
+        std::memcpy(inlineChars, other.inlineChars, sizeof(inlineChars));
+        pCharArray = inlineChars;
+    } else {
+        pCharArray = other.pCharArray;
+    }
+    other.pCharArray = nullptr; // Null the source pointer to avoid double deletion
+    other.length = 0;
+    other.prefix = 0;
+    other.ownsChars = false;
+}
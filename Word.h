@@ -1,21 +1,111 @@
 #ifndef WORD_H_
 #define WORD_H_
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
+#include <string_view>
 #include "NumList.h"
 
+class Arena;
+class OutputBuffer;
+
 /**
  * The Word class represents a word, containing a character array (C-string), a frequency, and a NumList.
  * It provides methods for managing and accessing the word and associated numbers.
+ * Words of up to kInlineCapacity characters are stored inside the object, so they need no allocation of their
+ * own. The length is stored, and the first eight characters are cached as a big-endian number, so most
+ * comparisons are decided by one integer compare without reading the characters.
  */
 class Word {
+public:
+    /** The longest word whose characters are stored inside the Word */
+    static constexpr size_t kInlineCapacity = 15;
+
+    /**
+     * The characters of a word to search for, with their prefix computed once for a whole search.
+     */
+    struct Key {
+        /** The characters */
+        std::string_view chars;
+
+        /** The first eight characters as a big-endian number (see Word::prefixOf) */
+        uint64_t prefix;
+
+        /**
+         * Constructor that computes the prefix of a sequence of characters.
+         * @param chars The characters to search for; they must outlive the Key.
+         */
+        explicit Key(std::string_view chars) : chars(chars), prefix(prefixOf(chars)) {}
+    };
+
+    /**
+     * Reads the first eight characters of a word as a big-endian number, padding short words with zero bytes.
+     * Prefixes compare like the words themselves: a word that sorts before another never has a larger prefix,
+     * and words with different prefixes are ordered by them.
+     * @param chars The characters of the word.
+     * @return The prefix.
+     */
+    static uint64_t prefixOf(std::string_view chars) {
+        unsigned char bytes[8] = {};
+        std::memcpy(bytes, chars.data(), std::min<size_t>(chars.size(), sizeof(bytes)));
+        uint64_t value = 0;
+        for (unsigned char byte : bytes) {
+            value = (value << 8) | byte;
+        }
+        return value;
+    }
+
 private:
 
-    char* pCharArray;   // A pointer to a character array (C-string) that holds the word.
+    char* pCharArray;   // A pointer to the characters (C-string): inlineChars, heap memory or Arena memory.
+
+    uint32_t length;    // The number of characters, without the terminating null.
 
     int frequency;      // An integer representing the number of occurrences of this word.
 
+    uint64_t prefix;    // The first eight characters as a big-endian number (see prefixOf).
+
+    char inlineChars[kInlineCapacity + 1];  // The characters of a short word, including the terminating null.
+
+    bool ownsChars;     // Whether pCharArray was allocated by this Word (false when inline or in an Arena).
+
     NumList num_list;   // A NumList holding the numbers associated with this word.
 
+    /**
+     * Stores a copy of some characters: inside the Word if they fit, otherwise in the Arena or on the heap.
+     * @param str The characters.
+     * @param arena The Arena for long words, or nullptr to use the heap.
+     */
+    void assignChars(std::string_view str, Arena* arena);
+
+    /**
+     * Takes over the characters of another Word, leaving it without characters.
+     * @param other The Word to take the characters from.
+     */
+    void takeChars(Word& other) noexcept;
+
+    /**
+     * Compares this Word with characters whose prefix is known.
+     * @param otherPrefix The prefix of the other characters.
+     * @param otherChars The other characters.
+     * @param otherLength The number of other characters.
+     * @return A negative value, 0, or a positive value if this Word is less than, equal to, or greater.
+     */
+    int compareWith(uint64_t otherPrefix, const char* otherChars, size_t otherLength) const {
+        if (prefix != otherPrefix) {
+            return prefix < otherPrefix ? -1 : 1;
+        }
+        // Equal prefixes mean the first eight characters match, so only the rest needs reading
+        size_t common = std::min<size_t>(length, otherLength);
+        if (common > sizeof(prefix)) {
+            int result = std::memcmp(pCharArray + sizeof(prefix), otherChars + sizeof(prefix), common - sizeof(prefix));
+            if (result != 0) {
+                return result;
+            }
+        }
+        return length < otherLength ? -1 : length > otherLength ? 1 : 0;
+    }
+
 public:
     /**
      * Constructor that creates a new Word using the supplied C-string pChArr and integer n.
@@ -24,6 +114,38 @@ public:
      */
     Word(const char* pChArr, int n);
 
+    /**
+     * Constructor that creates a new Word from the characters of a string_view and integer n.
+     * The characters are copied, so the viewed buffer does not need to outlive the Word.
+     * @param str The characters of the word.
+     * @param n An integer associated with the word.
+     */
+    Word(std::string_view str, int n);
+
+    /**
+     * Constructor that creates a new Word whose characters are copied into an Arena.
+     * The characters are released with the Arena, so the Word must not outlive it.
+     * @param str The characters of the word.
+     * @param n An integer associated with the word.
+     * @param arena The Arena that stores the characters.
+     */
+    Word(std::string_view str, int n, Arena& arena);
+
+    /**
+     * Copy constructor that places the copy's characters in an Arena.
+     * @param other The Word object to copy.
+     * @param arena The Arena that stores the characters of the copy.
+     */
+    Word(const Word& other, Arena& arena);
+
+    /**
+     * Move constructor that places the characters in an Arena unless they are inline or owned by other.
+     * The numbers are moved, not copied, so this is cheap even for frequent words.
+     * @param other The Word object to move resources from.
+     * @param arena The Arena that stores the characters of the new Word.
+     */
+    Word(Word&& other, Arena& arena);
+
     /**
      * The default constructor is explicitly deleted to prevent creation of a Word without parameters.
      */
@@ -64,7 +186,13 @@ public:
      * Returns a const pointer to the C-string representation of the Word.
      * @return A const pointer to the character array.
      */
-    const char* c_str() const;
+    const char* c_str() const { return pCharArray; }
+
+    /**
+     * Returns the characters of the Word.
+     * @return A view of the characters, valid as long as the Word.
+     */
+    std::string_view view() const { return std::string_view(pCharArray, length); }
 
     /**
      * Adds a number to the end of the Word's NumList.
@@ -73,10 +201,34 @@ public:
     void appendNumber(int n);
 
     /**
-     * Returns the length of the Word's C-string.
+     * Merges the occurrences of another Word into this one.
+     * Its numbers are appended after this Word's numbers and its frequency is added to this Word's frequency.
+     * @param other The Word whose occurrences are merged in.
+     * @param lineOffset The amount added to each of the other Word's numbers (default is 0).
+     */
+    void merge(const Word& other, int lineOffset = 0);
+
+    /**
+     * Adds the same amount to every number in the Word's NumList.
+     * @param lineOffset The amount to add.
+     */
+    void shiftNumbers(int lineOffset);
+
+    /**
+     * Switches the Word's NumList to its delta + varint compressed mode.
+     */
+    void compressNumbers();
+
+    /**
+     * Switches the Word's NumList back to plain ints.
+     */
+    void decompressNumbers();
+
+    /**
+     * Returns the length of the Word's C-string, which is stored rather than measured.
      * @return The length of the character array.
      */
-    size_t size() const;
+    size_t size() const { return length; }
 
     /**
      * Writes the Word's character array and its NumList to an output stream.
@@ -84,6 +236,12 @@ public:
      */
     void print(std::ostream& out) const;
 
+    /**
+     * Appends the Word's character array and its NumList to an output buffer, in the same format as print(std::ostream&).
+     * @param out The buffer to append to.
+     */
+    void print(OutputBuffer& out) const;
+
     /**
      * Returns a constant reference to the Word's NumList.
      * @return A constant reference to the NumList.
@@ -96,7 +254,22 @@ public:
      * @param other The Word to compare with.
      * @return An integer representing the comparison result.
      */
-    int compare(const Word& other) const;
+    int compare(const Word& other) const { return compareWith(other.prefix, other.pCharArray, other.length); }
+
+    /**
+     * Compares this Word's character array to a sequence of characters, in the same order as compare(const Word&).
+     * @param str The characters to compare with.
+     * @return A negative value, 0, or a positive value if this Word is less than, equal to, or greater than str.
+     */
+    int compare(std::string_view str) const { return compare(Key(str)); }
+
+    /**
+     * Compares this Word to a search key, in the same order as compare(const Word&).
+     * @param key The characters to compare with and their prefix.
+     * @return A negative value, 0, or a positive value if this Word is less than, equal to, or greater than key.
+     */
+    int compare(const Key& key) const { return compareWith(key.prefix, key.chars.data(), key.chars.size()); }
+
     int getFrequency() const; // Getter for frequency member
 
 };
@@ -0,0 +1,439 @@
+#include <algorithm>
+#include <cstdint>
+#include "WordBucket.h"
+
+/**
+ * Default constructor that creates an empty WordBucket with the default partitioning.
+ */
+WordBucket::WordBucket() {
+    partitions.push_back(Partition{ 0, WordList(), nextLimit(0) });
+}
+
+/**
+ * Copy constructor. The copy allocates from the heap, like a copied WordList.
+ * @param other The WordBucket to copy.
+ */
+WordBucket::WordBucket(const WordBucket& other) : WordBucket() {
+    *this = other;
+}
+
+/**
+ * Move constructor. Only the single empty partition of the new bucket is allocated before the move.
+ * @param other The WordBucket to move from; it is left empty.
+ */
+WordBucket::WordBucket(WordBucket&& other) noexcept : WordBucket() {
+    *this = std::move(other);
+}
+
+/**
+ * Copy assignment operator. The copied words are allocated from this bucket's Arena.
+ * @param rhs The WordBucket to copy, including its partitioning.
+ * @return A reference to this WordBucket.
+ */
+WordBucket& WordBucket::operator=(const WordBucket& rhs) {
+    if (this != &rhs) {
+        partitions.clear();
+        for (const Partition& source : rhs.partitions) {
+            partitions.push_back(Partition{ source.low, WordList(), source.limit });
+            partitions.back().words.setArena(arena);
+            partitions.back().words = source.words;
+        }
+        prefixBytes = rhs.prefixBytes;
+        splitThreshold = rhs.splitThreshold;
+        count = rhs.count;
+    }
+    return *this;
+}
+
+/**
+ * Move assignment operator. The partitions keep the Arena they allocate from; the moved-from bucket no longer
+ * refers to it.
+ * @param rhs The WordBucket to move from; it is left empty, allocating from the heap.
+ * @return A reference to this WordBucket.
+ */
+WordBucket& WordBucket::operator=(WordBucket&& rhs) noexcept {
+    if (this != &rhs) {
+        partitions.swap(rhs.partitions);
+        prefixBytes = rhs.prefixBytes;
+        splitThreshold = rhs.splitThreshold;
+        count = rhs.count;
+        arena = rhs.arena;
+        // Keep the first of the old partitions as the empty one, so nothing is allocated
+        rhs.partitions.erase(rhs.partitions.begin() + 1, rhs.partitions.end());
+        rhs.partitions.front() = Partition{ 0, WordList(), rhs.nextLimit(0) };
+        rhs.arena = nullptr;
+        rhs.count = 0;
+    }
+    return *this;
+}
+
+/**
+ * Sets how the bucket is partitioned and repartitions the words already in it.
+ * @param bytes The number of leading bytes partition boundaries may use, from 1 to kMaxPrefixBytes.
+ * @param threshold The number of words a partition may hold before it is split, or 0 to never split.
+ */
+void WordBucket::setPartitioning(unsigned bytes, size_t threshold) {
+    prefixBytes = std::min(std::max(bytes, 1u), kMaxPrefixBytes);
+    splitThreshold = threshold;
+    distribute(collapse());
+}
+
+/**
+ * Returns the number of leading bytes partition boundaries may use.
+ * @return The prefix length in bytes.
+ */
+unsigned WordBucket::getPrefixBytes() const {
+    return prefixBytes;
+}
+
+/**
+ * Returns the number of words a partition may hold before it is split.
+ * @return The split threshold, or 0 if partitions are never split.
+ */
+size_t WordBucket::getSplitThreshold() const {
+    return splitThreshold;
+}
+
+/**
+ * Sets the Arena that nodes and characters added from now on are allocated from.
+ * @param newArena The Arena to use, or nullptr to allocate from the heap.
+ */
+void WordBucket::setArena(Arena* newArena) {
+    arena = newArena;
+    for (Partition& part : partitions) {
+        part.words.setArena(newArena);
+    }
+}
+
+/**
+ * Checks if the WordBucket is empty.
+ * @return true if the WordBucket holds no Word, false otherwise.
+ */
+bool WordBucket::empty() const {
+    return count == 0;
+}
+
+/**
+ * Returns the number of Words in the WordBucket.
+ * @return The number of Words.
+ */
+size_t WordBucket::listSize() const {
+    return count;
+}
+
+/**
+ * Returns the number of partitions.
+ * @return The number of partitions, at least 1.
+ */
+size_t WordBucket::partitionCount() const {
+    return partitions.size();
+}
+
+/**
+ * Returns one partition.
+ * @param index The index of the partition, less than partitionCount().
+ * @return The words of the partition.
+ */
+const WordList& WordBucket::partition(size_t index) const {
+    return partitions[index].words;
+}
+
+/**
+ * Adds a Word in sorted order, given its characters and line number.
+ * The partition is split once it has grown past its limit.
+ * @param str The characters of the Word.
+ * @param lineNum The line number associated with the Word.
+ * @return A reference to the Word stored in the bucket.
+ */
+Word& WordBucket::addSorted(std::string_view str, int lineNum) {
+    size_t index = partitionFor(prefixKey(str));
+    WordList& words = partitions[index].words;
+    size_t before = words.listSize();
+    Word& added = words.addSorted(str, lineNum);
+    if (words.listSize() != before) {
+        ++count;
+        if (words.listSize() > partitions[index].limit) {
+            split(index); // Nodes are relinked, not moved, so added stays valid
+        }
+    }
+    return added;
+}
+
+/**
+ * Finds a Word by its characters.
+ * @param str The characters of the Word to look for.
+ * @return A pointer to the Word, or nullptr if it is not in the bucket.
+ */
+const Word* WordBucket::find(std::string_view str) const {
+    return partitions[partitionFor(prefixKey(str))].words.find(str);
+}
+
+/**
+ * Seeks to the first Word that is not less than a sequence of characters.
+ * @param str The characters to seek to.
+ * @return An iterator to the first Word not less than str, or end() if every Word is less.
+ */
+WordBucket::const_iterator WordBucket::seek(std::string_view str) const {
+    size_t index = partitionFor(prefixKey(str));
+    return const_iterator(&partitions, index, partitions[index].words.seek(str));
+}
+
+/**
+ * Merges another sorted WordBucket into this one in linear time, leaving the other bucket empty.
+ * Both buckets are joined into single lists, merged, and cut into partitions again.
+ * @param other The WordBucket to merge in.
+ * @param lineOffset The amount added to each number taken from the other bucket.
+ */
+void WordBucket::merge(WordBucket&& other, int lineOffset) {
+    if (this == &other) {
+        return;
+    }
+    WordList words = collapse();
+    WordList theirs = other.collapse();
+    other.distribute(WordList());
+    words.merge(std::move(theirs), lineOffset);
+    distribute(std::move(words));
+}
+
+/**
+ * Merges a copy of another sorted WordBucket into this one in linear time. The words of this bucket are cut
+ * at the partition boundaries of the other bucket, from the back so each cut only walks the words it moves,
+ * and every piece is merged with the matching partition before the pieces are joined again.
+ * @param other The WordBucket to merge in.
+ * @param lineOffset The amount added to each number taken from the other bucket.
+ */
+void WordBucket::merge(const WordBucket& other, int lineOffset) {
+    if (this == &other) {
+        merge(WordBucket(other), lineOffset);
+        return;
+    }
+    WordList words = collapse();
+    std::vector<WordList> pieces(other.partitions.size());
+    for (size_t i = other.partitions.size(); i-- > 0;) {
+        pieces[i] = i > 0 ? cutAt(words, other.partitions[i].low) : std::move(words);
+        pieces[i].setArena(arena);
+        pieces[i].merge(other.partitions[i].words, lineOffset);
+    }
+    for (size_t i = 1; i < pieces.size(); ++i) {
+        pieces[0].append(std::move(pieces[i]));
+    }
+    distribute(std::move(pieces[0]));
+}
+
+/**
+ * Replaces the contents of the bucket with a sorted list, which is partitioned afresh.
+ * @param words The new Words of the bucket in sorted order.
+ */
+void WordBucket::assign(WordList&& words) {
+    WordList old = collapse(); // Destroyed on return, together with the Words it holds
+    distribute(std::move(words));
+}
+
+/**
+ * Moves every Word into new nodes allocated in sorted order from an Arena, one partition after the other.
+ * @param target The Arena for the new nodes.
+ */
+void WordBucket::compact(Arena& target) {
+    arena = &target;
+    for (Partition& part : partitions) {
+        part.words.compact(target);
+    }
+}
+
+/**
+ * Prints the Words of the bucket in sorted order.
+ * @param sout The output stream to write to.
+ */
+void WordBucket::print(std::ostream& sout) const {
+    for (const Partition& part : partitions) {
+        part.words.print(sout);
+    }
+}
+
+/**
+ * Appends the Words of the bucket to an output buffer.
+ * @param out The buffer to append to.
+ */
+void WordBucket::print(OutputBuffer& out) const {
+    for (const Partition& part : partitions) {
+        part.words.print(out);
+    }
+}
+
+/**
+ * Returns an iterator to the first Word.
+ * @return An iterator to the first Word.
+ */
+WordBucket::iterator WordBucket::begin() {
+    return iterator(&partitions, 0, partitions[0].words.begin());
+}
+
+/**
+ * Returns an iterator past the last Word.
+ * @return An iterator past the last Word.
+ */
+WordBucket::iterator WordBucket::end() {
+    return iterator(&partitions, partitions.size(), WordList::iterator());
+}
+
+/**
+ * Returns a constant iterator to the first Word.
+ * @return A constant iterator to the first Word.
+ */
+WordBucket::const_iterator WordBucket::begin() const {
+    return const_iterator(&partitions, 0, partitions[0].words.begin());
+}
+
+/**
+ * Returns a constant iterator past the last Word.
+ * @return A constant iterator past the last Word.
+ */
+WordBucket::const_iterator WordBucket::end() const {
+    return const_iterator(&partitions, partitions.size(), WordList::const_iterator());
+}
+
+// Private member functions
+/**
+ * Computes the prefix key of a word. Keys compare like the words themselves: a word that sorts before another
+ * never has a larger key.
+ * @param word The characters of the word.
+ * @return The first prefixBytes bytes of word as a big-endian number, padded with zero bytes.
+ */
+uint32_t WordBucket::prefixKey(std::string_view word) const {
+    uint32_t key = 0;
+    for (unsigned i = 0; i < kMaxPrefixBytes; ++i) {
+        key <<= 8;
+        if (i < prefixBytes && i < word.size()) {
+            key |= static_cast<unsigned char>(word[i]);
+        }
+    }
+    return key;
+}
+
+/**
+ * Spells out a prefix key. Only the zero bytes at the end are padding: words can hold zero bytes (the tokenizer
+ * does not split on them), so zero bytes before a non-zero one are characters. A word sorts at or after these
+ * characters exactly when its prefix key is at least key.
+ * @param key A prefix key of some word.
+ * @return The bytes of the key up to its last non-zero byte.
+ */
+std::string WordBucket::keyString(uint32_t key) {
+    std::string bytes;
+    for (int shift = 8 * (kMaxPrefixBytes - 1); shift >= 0; shift -= 8) {
+        bytes.push_back(static_cast<char>((key >> shift) & 0xFF));
+    }
+    while (!bytes.empty() && bytes.back() == '\0') {
+        bytes.pop_back();
+    }
+    return bytes;
+}
+
+/**
+ * Moves the Words whose prefix key is at least key out of a sorted list.
+ * @param words The sorted list to cut; it keeps the Words with smaller keys.
+ * @param key The prefix key to cut at.
+ * @return The Words from the cut on, in sorted order.
+ */
+WordList WordBucket::cutAt(WordList& words, uint32_t key) {
+    return words.split(keyString(key));
+}
+
+/**
+ * Finds the partition a prefix key belongs to with a binary search over the low keys.
+ * @param key The prefix key.
+ * @return The index of the last partition whose low key is not greater than key.
+ */
+size_t WordBucket::partitionFor(uint32_t key) const {
+    auto after = std::upper_bound(partitions.begin() + 1, partitions.end(), key,
+                                  [](uint32_t value, const Partition& part) { return value < part.low; });
+    return static_cast<size_t>(after - partitions.begin()) - 1;
+}
+
+/**
+ * Returns the size at which a partition is split next. Doubling it after every attempt keeps the cost of
+ * partitions that cannot be split, because all their words share a prefix, amortized constant per word.
+ * @param size The current size of the partition.
+ * @return Twice the larger of size and the split threshold, or SIZE_MAX if partitions are never split.
+ */
+size_t WordBucket::nextLimit(size_t size) const {
+    if (splitThreshold == 0) {
+        return SIZE_MAX;
+    }
+    return size < splitThreshold ? splitThreshold : 2 * size;
+}
+
+/**
+ * Cuts an oversized partition in two at a prefix boundary near its middle: at the key of the middle word if
+ * some word before it has a smaller key, otherwise at the first larger key after it.
+ * @param index The index of the partition.
+ */
+void WordBucket::split(size_t index) {
+    Partition& part = partitions[index];
+    WordList::iterator it = part.words.begin();
+    for (size_t i = 0; i < part.words.listSize() / 2; ++i) {
+        ++it;
+    }
+    uint32_t cut = prefixKey(it->view());
+    if (prefixKey(part.words.front().view()) == cut) {
+        while (it != part.words.end() && prefixKey(it->view()) == cut) {
+            ++it;
+        }
+        if (it == part.words.end()) { // Every word from the front to the middle and on shares one prefix
+            part.limit = nextLimit(part.words.listSize());
+            return;
+        }
+        cut = prefixKey(it->view());
+    }
+    WordList upper = cutAt(part.words, cut);
+    part.limit = nextLimit(part.words.listSize());
+    size_t upperLimit = nextLimit(upper.listSize());
+    partitions.insert(partitions.begin() + index + 1, Partition{ cut, std::move(upper), upperLimit });
+}
+
+/**
+ * Joins all partitions into one list, leaving the bucket without partitions.
+ * @return Every Word of the bucket in sorted order.
+ */
+WordList WordBucket::collapse() {
+    WordList words = std::move(partitions[0].words);
+    for (size_t i = 1; i < partitions.size(); ++i) {
+        words.append(std::move(partitions[i].words));
+    }
+    partitions.clear();
+    count = 0;
+    return words;
+}
+
+/**
+ * Replaces the partitions with ones cut from a sorted list. One forward pass picks a cut at the first new
+ * prefix key after every half threshold of words; the cuts are then made from the back so each one only walks
+ * the words it moves, which keeps the whole pass linear.
+ * @param words Every Word of the bucket in sorted order.
+ */
+void WordBucket::distribute(WordList&& words) {
+    std::vector<uint32_t> cuts;
+    size_t target = splitThreshold == 0 ? SIZE_MAX : std::max<size_t>(splitThreshold / 2, 1);
+    size_t run = 0;
+    uint32_t previous = 0;
+    for (const Word& word : words) {
+        uint32_t key = prefixKey(word.view());
+        if (run >= target && key != previous) {
+            cuts.push_back(key);
+            run = 0;
+        }
+        previous = key;
+        ++run;
+    }
+
+    count = words.listSize();
+    partitions.assign(cuts.size() + 1, Partition{ 0, WordList(), 0 });
+    for (size_t i = cuts.size(); i > 0; --i) {
+        partitions[i].low = cuts[i - 1];
+        partitions[i].words = cutAt(words, cuts[i - 1]);
+    }
+    partitions[0].words = std::move(words);
+    for (Partition& part : partitions) {
+        part.words.setArena(arena);
+        part.limit = nextLimit(part.words.listSize());
+    }
+}
@@ -0,0 +1,334 @@
+#ifndef WORDBUCKET_H_
+#define WORDBUCKET_H_
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "Arena.h"
+#include "WordList.h"
+
+/**
+ * The WordBucket class holds the words of one Dictionary bucket as a run of WordList partitions.
+ * Each partition covers a range of prefix keys, the first one to three bytes of a word read as a big-endian
+ * number, and the ranges follow each other in key order, so walking the partitions in turn visits every Word
+ * in sorted order. A word is routed to its partition with a binary search over integer keys, and a partition
+ * that grows past the split threshold is cut in two at a prefix boundary. Large buckets thus become many
+ * small skip lists, which keeps searches shallow and gives independent units of work.
+ */
+class WordBucket {
+public:
+    /** The most leading bytes a prefix key can hold */
+    static constexpr unsigned kMaxPrefixBytes = 3;
+
+    /** The default number of words a partition may hold before it is split */
+    static constexpr size_t kDefaultSplitThreshold = 4096;
+
+private:
+    /**
+     * One range of the bucket.
+     */
+    struct Partition {
+        /** The smallest prefix key of the range; the range runs up to the low key of the next partition */
+        uint32_t low;
+
+        /** The words of the range */
+        WordList words;
+
+        /** The size at which splitting the partition is tried next */
+        size_t limit;
+    };
+
+    /** The partitions in key order; never empty, and the first one starts at key 0 */
+    std::vector<Partition> partitions;
+
+    /** The number of leading bytes in a prefix key */
+    unsigned prefixBytes{ kMaxPrefixBytes };
+
+    /** The number of words a partition may hold before it is split, or 0 to never split */
+    size_t splitThreshold{ kDefaultSplitThreshold };
+
+    /** The number of words in all partitions */
+    size_t count{ 0 };
+
+    /** Arena that new nodes are allocated from, or nullptr to use the heap */
+    Arena* arena{ nullptr };
+
+    /**
+     * Computes the prefix key of a word.
+     * @param word The characters of the word.
+     * @return The first prefixBytes bytes of word as a big-endian number, padded with zero bytes.
+     */
+    uint32_t prefixKey(std::string_view word) const;
+
+    /**
+     * Spells out a prefix key as the shortest string that every word with that key or a larger one sorts after.
+     * @param key A prefix key of some word.
+     * @return The bytes of the key up to its last non-zero byte; zero bytes before it are kept.
+     */
+    static std::string keyString(uint32_t key);
+
+    /**
+     * Moves the Words whose prefix key is at least key out of a sorted list (see WordList::split).
+     * @param words The sorted list to cut; it keeps the Words with smaller keys.
+     * @param key The prefix key to cut at.
+     * @return The Words from the cut on, in sorted order.
+     */
+    static WordList cutAt(WordList& words, uint32_t key);
+
+    /**
+     * Finds the partition a prefix key belongs to.
+     * @param key The prefix key.
+     * @return The index of the last partition whose low key is not greater than key.
+     */
+    size_t partitionFor(uint32_t key) const;
+
+    /**
+     * Returns the size at which a partition is split next.
+     * @param size The current size of the partition.
+     * @return Twice the larger of size and the split threshold, or SIZE_MAX if partitions are never split.
+     */
+    size_t nextLimit(size_t size) const;
+
+    /**
+     * Cuts an oversized partition in two at a prefix boundary near its middle.
+     * @param index The index of the partition.
+     */
+    void split(size_t index);
+
+    /**
+     * Joins all partitions into one list, leaving the bucket without partitions.
+     * @return Every Word of the bucket in sorted order.
+     */
+    WordList collapse();
+
+    /**
+     * Replaces the partitions with ones cut from a sorted list, each about half the split threshold.
+     * @param words Every Word of the bucket in sorted order.
+     */
+    void distribute(WordList&& words);
+
+public:
+    /**
+     * Forward iterator over the Words of a WordBucket in sorted order.
+     */
+    class iterator {
+    private:
+        std::vector<Partition>* partitions;
+        size_t index;
+        WordList::iterator position;
+        friend class WordBucket;
+
+        /** Moves past empty partitions to the next Word, if any */
+        void settle() {
+            while (position == WordList::iterator() && ++index < partitions->size()) {
+                position = (*partitions)[index].words.begin();
+            }
+        }
+    public:
+        iterator(std::vector<Partition>* partitions, size_t index, WordList::iterator position)
+            : partitions(partitions), index(index), position(position) { settle(); }
+        Word& operator*() const { return *position; }
+        Word* operator->() const { return &*position; }
+        iterator& operator++() { ++position; settle(); return *this; }
+        bool operator==(const iterator& other) const { return position == other.position; }
+        bool operator!=(const iterator& other) const { return position != other.position; }
+    };
+
+    /**
+     * Forward iterator over the Words of a constant WordBucket in sorted order.
+     */
+    class const_iterator {
+    private:
+        const std::vector<Partition>* partitions;
+        size_t index;
+        WordList::const_iterator position;
+        friend class WordBucket;
+
+        /** Moves past empty partitions to the next Word, if any */
+        void settle() {
+            while (position == WordList::const_iterator() && ++index < partitions->size()) {
+                position = (*partitions)[index].words.begin();
+            }
+        }
+    public:
+        const_iterator(const std::vector<Partition>* partitions, size_t index, WordList::const_iterator position)
+            : partitions(partitions), index(index), position(position) { settle(); }
+        const Word& operator*() const { return *position; }
+        const Word* operator->() const { return &*position; }
+        const_iterator& operator++() { ++position; settle(); return *this; }
+        bool operator==(const const_iterator& other) const { return position == other.position; }
+        bool operator!=(const const_iterator& other) const { return position != other.position; }
+    };
+
+    /**
+     * Default constructor that creates an empty WordBucket with the default partitioning.
+     */
+    WordBucket();
+
+    /**
+     * Copy constructor. The copy allocates from the heap, like a copied WordList.
+     * @param other The WordBucket to copy.
+     */
+    WordBucket(const WordBucket& other);
+
+    /**
+     * Move constructor.
+     * @param other The WordBucket to move from; it is left empty.
+     */
+    WordBucket(WordBucket&& other) noexcept;
+
+    /**
+     * Copy assignment operator. The copied words are allocated from this bucket's Arena.
+     * @param rhs The WordBucket to copy, including its partitioning.
+     * @return A reference to this WordBucket.
+     */
+    WordBucket& operator=(const WordBucket& rhs);
+
+    /**
+     * Move assignment operator.
+     * @param rhs The WordBucket to move from; it is left empty and allocating from the heap.
+     * @return A reference to this WordBucket.
+     */
+    WordBucket& operator=(WordBucket&& rhs) noexcept;
+
+    /**
+     * Sets how the bucket is partitioned and repartitions the words already in it.
+     * @param bytes The number of leading bytes partition boundaries may use, from 1 to kMaxPrefixBytes.
+     * @param threshold The number of words a partition may hold before it is split, or 0 to never split.
+     */
+    void setPartitioning(unsigned bytes, size_t threshold);
+
+    /**
+     * Returns the number of leading bytes partition boundaries may use.
+     * @return The prefix length in bytes.
+     */
+    unsigned getPrefixBytes() const;
+
+    /**
+     * Returns the number of words a partition may hold before it is split.
+     * @return The split threshold, or 0 if partitions are never split.
+     */
+    size_t getSplitThreshold() const;
+
+    /**
+     * Sets the Arena that nodes and characters added from now on are allocated from.
+     * @param newArena The Arena to use, or nullptr to allocate from the heap.
+     */
+    void setArena(Arena* newArena);
+
+    /**
+     * Checks if the WordBucket is empty.
+     * @return true if the WordBucket holds no Word, false otherwise.
+     */
+    bool empty() const;
+
+    /**
+     * Returns the number of Words in the WordBucket.
+     * @return The number of Words.
+     */
+    size_t listSize() const;
+
+    /**
+     * Returns the number of partitions.
+     * @return The number of partitions, at least 1.
+     */
+    size_t partitionCount() const;
+
+    /**
+     * Returns one partition. Partitions can be worked on independently, e.g. one per thread.
+     * @param index The index of the partition, less than partitionCount().
+     * @return The words of the partition, in sorted order and all before those of the next partition.
+     */
+    const WordList& partition(size_t index) const;
+
+    /**
+     * Adds a Word in sorted order, given its characters and line number (see WordList::addSorted).
+     * @param str The characters of the Word.
+     * @param lineNum The line number associated with the Word.
+     * @return A reference to the Word stored in the bucket. It stays valid while the bucket exists.
+     */
+    Word& addSorted(std::string_view str, int lineNum);
+
+    /**
+     * Finds a Word by its characters.
+     * @param str The characters of the Word to look for.
+     * @return A pointer to the Word, or nullptr if it is not in the bucket.
+     */
+    const Word* find(std::string_view str) const;
+
+    /**
+     * Seeks to the first Word that is not less than a sequence of characters.
+     * @param str The characters to seek to.
+     * @return An iterator to the first Word not less than str, or end() if every Word is less.
+     */
+    const_iterator seek(std::string_view str) const;
+
+    /**
+     * Merges another sorted WordBucket into this one in linear time, leaving the other bucket empty
+     * (see WordList::merge). The result is partitioned afresh.
+     * @param other The WordBucket to merge in.
+     * @param lineOffset The amount added to each number taken from the other bucket (default is 0).
+     */
+    void merge(WordBucket&& other, int lineOffset = 0);
+
+    /**
+     * Merges a copy of another sorted WordBucket into this one in linear time, leaving the other bucket as it is
+     * (see WordList::merge(const WordList&, int)). The result is partitioned afresh.
+     * @param other The WordBucket to merge in.
+     * @param lineOffset The amount added to each number taken from the other bucket (default is 0).
+     */
+    void merge(const WordBucket& other, int lineOffset = 0);
+
+    /**
+     * Replaces the contents of the bucket with a sorted list, which is partitioned afresh.
+     * The nodes of the list are relinked rather than copied, so an Arena they live in must outlive this bucket.
+     * @param words The new Words of the bucket in sorted order; the list is left empty.
+     */
+    void assign(WordList&& words);
+
+    /**
+     * Moves every Word into new nodes allocated in sorted order from an Arena (see WordList::compact).
+     * @param target The Arena for the new nodes; the bucket allocates from it from now on.
+     */
+    void compact(Arena& target);
+
+    /**
+     * Prints the Words of the bucket in sorted order.
+     * @param sout The output stream to write to.
+     */
+    void print(std::ostream& sout) const;
+
+    /**
+     * Appends the Words of the bucket to an output buffer, in the same format as print(std::ostream&).
+     * @param out The buffer to append to.
+     */
+    void print(OutputBuffer& out) const;
+
+    /**
+     * Returns an iterator to the first Word.
+     * @return An iterator to the first Word.
+     */
+    iterator begin();
+
+    /**
+     * Returns an iterator past the last Word.
+     * @return An iterator past the last Word.
+     */
+    iterator end();
+
+    /**
+     * Returns a constant iterator to the first Word.
+     * @return A constant iterator to the first Word.
+     */
+    const_iterator begin() const;
+
+    /**
+     * Returns a constant iterator past the last Word.
+     * @return A constant iterator past the last Word.
+     */
+    const_iterator end() const;
+};
+
+#endif /* WORDBUCKET_H_ */
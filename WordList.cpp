@@ -1,4 +1,8 @@
+#include <algorithm>
+#include <initializer_list>
+#include <new>
 #include "WordList.h"
+#include "OutputBuffer.h"
 
 /**
  * Default constructor that initializes an empty WordList.
@@ -11,21 +15,22 @@ WordList::WordList() : head(nullptr), tail(nullptr), size(0) {}
  */
 
 WordList::WordList(const WordList& list) : head(nullptr), tail(nullptr), size(0) {
-    WordNode* temp = list.head;
-    while (temp != nullptr) {
-        this->addBack(temp->theWord);
-        temp = temp->next;
-    }
+    copyFrom(list);
 }
 
 /**
  * Move constructor that creates a new WordList by moving the resources from another WordList.
  * @param list The WordList to move resources from.
  */
-WordList::WordList(WordList&& list) : head(list.head), tail(list.tail), size(list.size) {
+WordList::WordList(WordList&& list) noexcept
+        : head(list.head), tail(list.tail), size(list.size), levels(list.levels), arena(list.arena) {
+    std::copy(list.skipHeads, list.skipHeads + kMaxLevel - 1, skipHeads);
+    std::fill(list.skipHeads, list.skipHeads + kMaxLevel - 1, nullptr);
     list.head = nullptr;
     list.tail = nullptr;
     list.size = 0;
+    list.levels = 1;
+    list.arena = nullptr;
 }
 
 
@@ -36,14 +41,8 @@ WordList::WordList(WordList&& list) : head(list.head), tail(list.tail), size(lis
  */
 WordList& WordList::operator=(const WordList& rhs) {
     if (this != &rhs) {
-        while (head != nullptr) {
-            removeFront();
-        }
-        WordNode* temp = rhs.head;
-        while (temp != nullptr) {
-            addBack(temp->theWord);
-            temp = temp->next;
-        }
+        clear();
+        copyFrom(rhs);
     }
     return *this;
 }
@@ -53,17 +52,21 @@ WordList& WordList::operator=(const WordList& rhs) {
  * @param rhs The WordList to move resources from.
  * @return A reference to the updated WordList.
  */
-WordList& WordList::operator=(WordList&& rhs) {
+WordList& WordList::operator=(WordList&& rhs) noexcept {
     if (this != &rhs) {
-        while (head != nullptr) {
-            removeFront();
-        }
+        clear();
         head = rhs.head;
         tail = rhs.tail;
         size = rhs.size;
+        levels = rhs.levels;
+        arena = rhs.arena;
+        std::copy(rhs.skipHeads, rhs.skipHeads + kMaxLevel - 1, skipHeads);
+        std::fill(rhs.skipHeads, rhs.skipHeads + kMaxLevel - 1, nullptr);
         rhs.head = nullptr;
         rhs.tail = nullptr;
         rhs.size = 0;
+        rhs.levels = 1;
+        rhs.arena = nullptr;
     }
     return *this;
 }
@@ -72,9 +75,7 @@ WordList& WordList::operator=(WordList&& rhs) {
  * Destructor that cleans up the memory allocated for the WordList.
  */
 WordList::~WordList() {
-    while (head != nullptr) {
-        removeFront();
-    }
+    clear();
 }
 
 /**
@@ -105,6 +106,16 @@ void WordList::print(std::ostream& sout) const {
     }
 }
 
+/**
+ * Appends the WordList to an output buffer.
+ * @param out The buffer to append to.
+ */
+void WordList::print(OutputBuffer& out) const {
+    for (WordNode* temp = head; temp != nullptr; temp = temp->next) {
+        temp->theWord.print(out);
+    }
+}
+
 /**
  * Retrieves the Word at the front of the WordList.
  * @return A constant reference to the Word at the front.
@@ -125,30 +136,42 @@ const Word& WordList::back() const {
 
 /**
 Adds a Word to the WordList in sorted order.
+If the Word is already in the list, its line numbers are appended to the existing Word instead.
 @param aWord The Word to add.
+@return A reference to the Word stored in the list.
 */
-void WordList::addSorted(const Word& aWord) {
-    if (head == nullptr || aWord.compare(head->theWord) < 0) {
-        // The list is empty or the word is smaller than the current head, so it becomes the new head
-        addFront(aWord);
-    } else {
-        // Find the node after which to insert the new word
-        WordNode* current = head;
-        while (current->next != nullptr && current->next->theWord.compare(aWord) < 0) {
-            current = current->next;
+Word& WordList::addSorted(const Word& aWord) {
+    WordNode* update[kMaxLevel];
+    WordNode* found = findPredecessors(&aWord, update);
+    if (found != nullptr && found->theWord.compare(aWord) == 0) {
+        // Word already exists, increment its frequency and append the line numbers
+        const NumList& numbers = aWord.getNumberList();
+        for (int i = 0; i < numbers.getSize(); i++) {
+            found->theWord.appendNumber(numbers.get(i));
         }
-        // Insert the new word after the found node
-        addAfter(current, aWord);
+        return found->theWord;
     }
+    // Word does not exist, link a new node in after the recorded predecessors
+    return insertAt(update, arena != nullptr ? Word(aWord, *arena) : Word(aWord))->theWord;
 }
 
 /**
-Adds a Word to the WordList in sorted order, given a string and a line number.
-@param str The string representing the Word.
+Adds a Word to the WordList in sorted order, given its characters and a line number.
+@param str The characters of the Word.
 @param lineNum The line number associated with the Word.
+@return A reference to the Word stored in the list.
 */
-void WordList::addSorted(const std::string& str, int lineNum) {
-    addSorted(Word(str.c_str(), lineNum));
+Word& WordList::addSorted(std::string_view str, int lineNum) {
+    WordNode* update[kMaxLevel];
+    Word::Key key(str); // The prefix is computed once for every comparison of the search
+    WordNode* found = findPredecessors(&key, update);
+    if (found != nullptr && found->theWord.compare(key) == 0) {
+        // Word already exists, increment its frequency and append the line number
+        found->theWord.appendNumber(lineNum);
+        return found->theWord;
+    }
+    // Only a new word gets its characters copied
+    return insertAt(update, arena != nullptr ? Word(str, lineNum, *arena) : Word(str, lineNum))->theWord;
 }
 
 /**
@@ -159,40 +182,24 @@ bool WordList::removeFront() {
     if (head == nullptr) {
         return false;
     }
-    WordNode* temp = head;
-    head = head->next;
-    delete temp;
-    if (head == nullptr) {
-        tail = nullptr;
-    }
-    size--;
+    // The head has no predecessor but the header on any of its levels
+    WordNode* update[kMaxLevel] = {};
+    unlinkAt(update, head);
     return true;
 }
 
 /**
  * Removes the back WordNode from the WordList.
- * If the WordList is empty or contains only one element, nothing is removed.
+ * If the WordList is empty, nothing is removed.
  */
 void WordList::removeBack() {
     // if the list is empty, there's nothing to remove
-    if (head == nullptr) return;
-
-    // if the list only contains one element, we remove it
-    if (head->next == nullptr) {
-        delete head;
-        head = nullptr;
-    } else {
-        // the list contains at least two elements, so we find the element before the last one
-        WordNode* current = head;
-        while (current->next->next != nullptr) {
-            current = current->next;
-        }
-        // now current points to the element before the last one
-        // we remove the last element
-        delete current->next;
-        // and update the next pointer of the current element
-        current->next = nullptr;
-    }
+    if (tail == nullptr) return;
+
+    // find the predecessors of the last node on every level and unlink it
+    WordNode* update[kMaxLevel];
+    findPredecessors(&tail->theWord, update);
+    unlinkAt(update, tail);
 }
 
 /**
@@ -201,122 +208,497 @@ Searches for a Word in the WordList.
 @return true if the Word is found in the WordList, false otherwise.
 */
 bool WordList::search(const Word& aWord) const {
-    WordNode* temp = head;
-    while (temp != nullptr) {
-        if (temp->theWord.compare(aWord) == 0) {
-            return true;
-        }
-        temp = temp->next;
+    return lookup(aWord) != nullptr;
+}
+
+/**
+ * Finds a Word in the WordList by its characters.
+ * @param str The characters of the Word to look for.
+ * @return A pointer to the Word, or nullptr if it is not in the list.
+ */
+const Word* WordList::find(std::string_view str) const {
+    Word::Key key(str);
+    WordNode* candidate = lowerBound(key);
+    if (candidate != nullptr && candidate->theWord.compare(key) == 0) {
+        return &candidate->theWord;
     }
-    return false;
+    return nullptr;
 }
 
-// Private member functions
 /**
- * Looks up a Word in the WordList.
- * @param aWord The Word to look up.
- * @return A pointer to the WordNode containing the Word, or nullptr if the Word is not found.
+ * Seeks to the first Word that is not less than a sequence of characters.
+ * @param str The characters to seek to.
+ * @return An iterator to the first Word not less than str, or end() if every Word is less.
  */
-WordList::WordNode* WordList::lookup(const Word& aWord) const {// Implement a lookup function
-    WordNode* temp = head;
-    while (temp != nullptr) {
-        if (temp->theWord.compare(aWord) == 0) {
-            return temp;
+WordList::const_iterator WordList::seek(std::string_view str) const {
+    return const_iterator(lowerBound(Word::Key(str)));
+}
+
+/**
+ * Merges another sorted WordList into this one in a single linear pass, leaving the other list empty.
+ * @param other The WordList to merge in.
+ * @param lineOffset The amount added to each number taken from the other list.
+ */
+void WordList::merge(WordList&& other, int lineOffset) {
+    if (this == &other) {
+        return;
+    }
+    WordNode* mine = head;
+    WordNode* theirs = other.head;
+
+    // Detach both chains and rebuild this list by appending nodes in order
+    for (WordList* list : { this, &other }) {
+        list->head = nullptr;
+        list->tail = nullptr;
+        list->size = 0;
+        list->levels = 1;
+        std::fill(list->skipHeads, list->skipHeads + kMaxLevel - 1, nullptr);
+    }
+    WordNode* last[kMaxLevel] = {};
+    while (mine != nullptr || theirs != nullptr) {
+        int order = mine == nullptr ? 1 : theirs == nullptr ? -1 : mine->theWord.compare(theirs->theWord);
+        WordNode* taken;
+        if (order <= 0) {
+            taken = mine;
+            mine = mine->next;
+            if (order == 0) {
+                // Same word in both lists: keep this node and drop the other one
+                WordNode* duplicate = theirs;
+                theirs = theirs->next;
+                taken->theWord.merge(duplicate->theWord, lineOffset);
+                destroyNode(duplicate);
+            }
+        } else {
+            taken = theirs;
+            theirs = theirs->next;
+            if (lineOffset != 0) {
+                taken->theWord.shiftNumbers(lineOffset);
+            }
         }
-        temp = temp->next;
+        appendNode(taken, last);
     }
-    return nullptr;
 }
 
 /**
- * Adds a Word to the front of the WordList.
- * @param aWord The Word to add.
+ * Merges a copy of another sorted WordList into this one in a single linear pass.
+ * Words of this list are relinked in place; Words only the other list holds are copied with their tower heights.
+ * @param other The WordList to merge in.
+ * @param lineOffset The amount added to each number taken from the other list.
  */
-void WordList::addFront(const Word& aWord) {
-    WordNode* newNode = new WordNode(aWord, head);
-    head = newNode;
-    if (tail == nullptr) {
-        tail = newNode;
+void WordList::merge(const WordList& other, int lineOffset) {
+    if (this == &other) {
+        merge(WordList(other), lineOffset);
+        return;
     }
-    size++;
+    WordNode* mine = head;
+    const WordNode* theirs = other.head;
 
-    if (head->next != nullptr && head->theWord.compare(head->next->theWord) == 0) {
-        // Word already exists, increment its frequency and append the line number
-        head->next->theWord.appendNumber(aWord.getNumberList().get(0));
-        delete newNode;
-        head = head->next;
-        size--;
+    // Detach this chain and rebuild the list by appending nodes in order
+    head = nullptr;
+    tail = nullptr;
+    size = 0;
+    levels = 1;
+    std::fill(skipHeads, skipHeads + kMaxLevel - 1, nullptr);
+    WordNode* last[kMaxLevel] = {};
+    while (mine != nullptr || theirs != nullptr) {
+        int order = mine == nullptr ? 1 : theirs == nullptr ? -1 : mine->theWord.compare(theirs->theWord);
+        WordNode* taken;
+        if (order <= 0) {
+            taken = mine;
+            mine = mine->next;
+            if (order == 0) {
+                // Same word in both lists: only the numbers are copied
+                taken->theWord.merge(theirs->theWord, lineOffset);
+                theirs = theirs->next;
+            }
+        } else {
+            Word copy = arena != nullptr ? Word(theirs->theWord, *arena) : Word(theirs->theWord);
+            if (lineOffset != 0) {
+                copy.shiftNumbers(lineOffset);
+            }
+            taken = createNode(std::move(copy), theirs->height);
+            theirs = theirs->next;
+        }
+        appendNode(taken, last);
     }
 }
 
+/**
+ * Moves every Word that is not less than a sequence of characters into a new list.
+ * The links into the moved part are cut on every level, then the moved nodes are appended to the new list
+ * keeping their tower heights, so neither list needs new nodes.
+ * @param from The characters to cut at.
+ * @return The Words from the cut on.
+ */
+WordList WordList::split(std::string_view from) {
+    WordList rest;
+    rest.arena = arena;
+    WordNode* update[kMaxLevel]{};
+    Word::Key key(from);
+    WordNode* moving = findPredecessors(&key, update);
+    if (moving == nullptr) {
+        return rest;
+    }
+    for (int level = 0; level < levels; ++level) {
+        linkAt(update[level], level) = nullptr;
+    }
+    tail = update[0];
+    while (levels > 1 && skipHeads[levels - 2] == nullptr) {
+        --levels;
+    }
+    WordNode* last[kMaxLevel] = {};
+    while (moving != nullptr) {
+        WordNode* nextNode = moving->next;
+        rest.appendNode(moving, last);
+        moving = nextNode;
+    }
+    size -= rest.size;
+    return rest;
+}
 
 /**
- * Adds a Word to the back of the WordList.
- * @param aWord The Word to add.
+ * Moves every Word of another list behind the last Word of this one, leaving the other list empty.
+ * @param other The WordList to append.
  */
-void WordList::addBack(const Word& aWord) {
-    WordNode* newNode = new WordNode(aWord);
-    if (tail == nullptr) {
-        head = tail = newNode;
-    } else {
-        tail->next = newNode;
-        tail = newNode;
+void WordList::append(WordList&& other) {
+    if (this == &other) {
+        return;
+    }
+    WordNode* last[kMaxLevel] = {};
+    findPredecessors<Word>(nullptr, last);
+    WordNode* moving = other.head;
+    other.head = nullptr;
+    other.tail = nullptr;
+    other.size = 0;
+    other.levels = 1;
+    std::fill(other.skipHeads, other.skipHeads + kMaxLevel - 1, nullptr);
+    while (moving != nullptr) {
+        WordNode* nextNode = moving->next;
+        appendNode(moving, last);
+        moving = nextNode;
     }
-    size++;
 }
 
 /**
- * Adds a Word after a specified WordNode in the WordList.
- * @param p The WordNode after which to add the Word.
- * @param aWord The Word to add.
+ * Moves a Word into a new node behind the last Word of the list.
+ * @param aWord The Word to append.
+ * @return A reference to the Word stored in the list.
  */
-void WordList::addAfter(WordNode* p, const Word& aWord) {
-    if (p == nullptr) {
-        addFront(aWord);
-    } else {
-        WordNode* nextNode = p->next;
-        // Check if the word already exists in the list
-        if (nextNode != nullptr && nextNode->theWord.compare(aWord) == 0) {
-            // Word already exists, increment its frequency and append the line number
-            nextNode->theWord.appendNumber(aWord.getNumberList().get(0));
-        } else {
-            // Word does not exist, create a new WordNode
-            WordNode* newNode = new WordNode(aWord, nextNode);
-            p->next = newNode;
-            if (tail == p) {
-                tail = newNode;
-            }
-            size++;
-        }
+Word& WordList::append(Word&& aWord) {
+    WordNode* update[kMaxLevel];
+    findPredecessors<Word>(nullptr, update);
+    return insertAt(update, std::move(aWord))->theWord;
+}
+
+/**
+ * Constructor that starts appending behind the current last Word of a list.
+ * @param list The list to append to.
+ */
+WordList::Appender::Appender(WordList& list) : list(list) {
+    list.findPredecessors<Word>(nullptr, last);
+}
+
+/**
+ * Moves a Word into a new node behind the last Word of the list.
+ * @param aWord The Word to append.
+ * @return A reference to the Word stored in the list.
+ */
+Word& WordList::Appender::append(Word&& aWord) {
+    WordNode* newNode = list.createNode(std::move(aWord), list.randomHeight());
+    list.appendNode(newNode, last);
+    return newNode->theWord;
+}
+
+/**
+ * Moves every Word into new nodes allocated in sorted order from an Arena.
+ * Each new node keeps the tower height of the node it replaces, so the shape of the index is unchanged.
+ * @param target The Arena for the new nodes.
+ */
+void WordList::compact(Arena& target) {
+    WordNode* node = head;
+    head = nullptr;
+    tail = nullptr;
+    size = 0;
+    levels = 1;
+    std::fill(skipHeads, skipHeads + kMaxLevel - 1, nullptr);
+    arena = &target;
+    WordNode* last[kMaxLevel] = {};
+    while (node != nullptr) {
+        WordNode* nextNode = node->next;
+        WordNode* moved = createNode(Word(std::move(node->theWord), target), node->height);
+        destroyNode(node);
+        appendNode(moved, last);
+        node = nextNode;
     }
 }
 
+/**
+ * Sets the Arena that nodes and characters added from now on are allocated from.
+ * @param newArena The Arena to use, or nullptr to allocate from the heap.
+ */
+void WordList::setArena(Arena* newArena) {
+    arena = newArena;
+}
 
+/**
+ * Returns an iterator to the first Word of the WordList.
+ * @return An iterator to the first Word.
+ */
+WordList::iterator WordList::begin() {
+    return iterator(head);
+}
+
+/**
+ * Returns an iterator past the last Word of the WordList.
+ * @return An iterator past the last Word.
+ */
+WordList::iterator WordList::end() {
+    return iterator(nullptr);
+}
+
+/**
+ * Returns a constant iterator to the first Word of the WordList.
+ * @return A constant iterator to the first Word.
+ */
+WordList::const_iterator WordList::begin() const {
+    return const_iterator(head);
+}
+
+/**
+ * Returns a constant iterator past the last Word of the WordList.
+ * @return A constant iterator past the last Word.
+ */
+WordList::const_iterator WordList::end() const {
+    return const_iterator(nullptr);
+}
+
+// Private member functions
+/**
+ * Looks up a Word in the WordList.
+ * @param aWord The Word to look up.
+ * @return A pointer to the WordNode containing the Word, or nullptr if the Word is not found.
+ */
+WordList::WordNode* WordList::lookup(const Word& aWord) const {
+    WordNode* candidate = lowerBound(aWord);
+    if (candidate != nullptr && candidate->theWord.compare(aWord) == 0) {
+        return candidate;
+    }
+    return nullptr;
+}
+
+/**
+ * Appends copies of every Word of another list in one pass. Each copy keeps the tower height of its original,
+ * so the copy gets the same index shape without drawing new heights or searching for predecessors.
+ * @param other The list to copy.
+ */
+void WordList::copyFrom(const WordList& other) {
+    WordNode* last[kMaxLevel] = {};
+    for (const WordNode* node = other.head; node != nullptr; node = node->next) {
+        Word copy = arena != nullptr ? Word(node->theWord, *arena) : Word(node->theWord);
+        appendNode(createNode(std::move(copy), node->height), last);
+    }
+}
 
 /**
  * Removes a WordNode from the WordList.
  * @param nodePtr A pointer to the WordNode to remove.
- * @return true if the WordNode was successfully removed, false if the WordNode is nullptr or the WordList is empty.
+ * @return true if the WordNode was successfully removed, false if the WordNode is nullptr or not in the WordList.
  */
 bool WordList::remove(WordNode* nodePtr) {
     if (nodePtr == nullptr || head == nullptr) {
         return false;
     }
-    if (nodePtr == head) {
-        return removeFront();
+    WordNode* update[kMaxLevel];
+    if (findPredecessors(&nodePtr->theWord, update) != nodePtr) {
+        return false;
     }
-    WordNode* temp = head;
-    while (temp->next != nodePtr) {
-        temp = temp->next;
-        if (temp == nullptr) {
-            return false;
+    unlinkAt(update, nodePtr);
+    return true;
+}
+
+/**
+ * Returns a reference to the link of a node at a given level.
+ * @param node The node whose link is wanted, or nullptr for the list header.
+ * @param level The level of the link.
+ * @return A reference to the link.
+ */
+WordList::WordNode*& WordList::linkAt(WordNode* node, int level) {
+    if (node == nullptr) {
+        return level == 0 ? head : skipHeads[level - 1];
+    }
+    return level == 0 ? node->next : node->skip()[level - 1];
+}
+
+/**
+ * Returns the successor of a node at a given level.
+ * @param node The node whose successor is wanted, or nullptr for the list header.
+ * @param level The level to follow.
+ * @return The successor at that level.
+ */
+WordList::WordNode* WordList::nextAt(const WordNode* node, int level) const {
+    if (node == nullptr) {
+        return level == 0 ? head : skipHeads[level - 1];
+    }
+    return level == 0 ? node->next : node->skip()[level - 1];
+}
+
+/**
+ * Picks a random tower height: each extra level is kept with probability 1/4.
+ * @return A height between 1 and kMaxLevel.
+ */
+int WordList::randomHeight() {
+    // xorshift32
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    unsigned int bits = seed;
+    int height = 1;
+    while (height < kMaxLevel && (bits & 3u) == 0) {
+        ++height;
+        bits >>= 2;
+    }
+    return height;
+}
+
+/**
+ * Descends the skip-list index, recording the last node before the key on every level.
+ * @param key The key to search for, or nullptr to search past the last node.
+ * @param update Receives the predecessor (nullptr for the header) on each level.
+ * @return The first node whose Word is not less than the key, or nullptr.
+ */
+template <typename Key>
+WordList::WordNode* WordList::findPredecessors(const Key* key, WordNode** update) {
+    WordNode* current = nullptr;
+    for (int level = levels - 1; level >= 0; --level) {
+        WordNode* nextNode = nextAt(current, level);
+        while (nextNode != nullptr && (key == nullptr || nextNode->theWord.compare(*key) < 0)) {
+            current = nextNode;
+            nextNode = nextAt(current, level);
+        }
+        update[level] = current;
+    }
+    return nextAt(current, 0);
+}
+
+/**
+ * Finds the first node whose Word is not less than a given key.
+ * @param key The key to search for.
+ * @return The first node not less than the key, or nullptr if every node is smaller.
+ */
+template <typename Key>
+WordList::WordNode* WordList::lowerBound(const Key& key) const {
+    const WordNode* current = nullptr;
+    for (int level = levels - 1; level >= 0; --level) {
+        WordNode* nextNode = nextAt(current, level);
+        while (nextNode != nullptr && nextNode->theWord.compare(key) < 0) {
+            current = nextNode;
+            nextNode = nextAt(current, level);
+        }
+    }
+    return nextAt(current, 0);
+}
+
+/**
+ * Links a new node in after the recorded predecessors.
+ * @param update The predecessors on each level, as filled by findPredecessors.
+ * @param aWord The Word to move into the new node.
+ * @return The new node.
+ */
+WordList::WordNode* WordList::insertAt(WordNode** update, Word&& aWord) {
+    int height = randomHeight();
+    if (height > levels) {
+        // The new levels start at the header
+        for (int level = levels; level < height; ++level) {
+            update[level] = nullptr;
         }
+        levels = height;
+    }
+    WordNode* newNode = createNode(std::move(aWord), height);
+    for (int level = 0; level < height; ++level) {
+        WordNode*& prevLink = linkAt(update[level], level);
+        linkAt(newNode, level) = prevLink;
+        prevLink = newNode;
+    }
+    if (newNode->next == nullptr) {
+        tail = newNode;
+    }
+    size++;
+    return newNode;
+}
+
+/**
+ * Unlinks and deletes a node given its recorded predecessors.
+ * @param update The predecessors on each level, as filled by findPredecessors.
+ * @param nodePtr The node to remove.
+ */
+void WordList::unlinkAt(WordNode** update, WordNode* nodePtr) {
+    for (int level = 0; level < nodePtr->height; ++level) {
+        linkAt(update[level], level) = linkAt(nodePtr, level);
     }
-    temp->next = nodePtr->next;
-    delete nodePtr;
-    if (temp->next == nullptr) {
-        tail = temp;
+    if (tail == nodePtr) {
+        tail = update[0];
     }
+    // Drop levels that became empty
+    while (levels > 1 && skipHeads[levels - 2] == nullptr) {
+        --levels;
+    }
+    destroyNode(nodePtr);
     size--;
-    return true;
+}
+
+/**
+ * Links a node in after the current last node on each of its levels.
+ * @param nodePtr The node to append. It must sort after every node already in the list.
+ * @param last The last node on each level (nullptr for the header); updated to nodePtr on its levels.
+ */
+void WordList::appendNode(WordNode* nodePtr, WordNode** last) {
+    for (int level = 0; level < nodePtr->height; ++level) {
+        linkAt(nodePtr, level) = nullptr;
+        linkAt(last[level], level) = nodePtr;
+        last[level] = nodePtr;
+    }
+    levels = std::max(levels, nodePtr->height);
+    tail = nodePtr;
+    size++;
+}
+
+/**
+ * Allocates a node together with its express links in a single block, from the Arena if there is one.
+ * @param aWord The Word to move into the node.
+ * @param height The number of levels the node is linked into.
+ * @return The new, unlinked node.
+ */
+WordList::WordNode* WordList::createNode(Word&& aWord, int height) {
+    size_t bytes = sizeof(WordNode) + (height - 1) * sizeof(WordNode*);
+    void* memory = arena != nullptr ? arena->allocate(bytes, alignof(WordNode)) : ::operator new(bytes);
+    return new (memory) WordNode(std::move(aWord), height, arena != nullptr);
+}
+
+/**
+ * Destroys a node created by createNode. Arena memory is left for the Arena to release.
+ * @param nodePtr The node to destroy.
+ */
+void WordList::destroyNode(WordNode* nodePtr) {
+    bool pooled = nodePtr->pooled;
+    nodePtr->~WordNode();
+    if (!pooled) {
+        ::operator delete(nodePtr);
+    }
+}
+
+/**
+ * Destroys every node in one pass over the bottom level and resets the list to empty.
+ */
+void WordList::clear() {
+    WordNode* current = head;
+    while (current != nullptr) {
+        WordNode* nextNode = current->next;
+        destroyNode(current);
+        current = nextNode;
+    }
+    head = nullptr;
+    tail = nullptr;
+    size = 0;
+    levels = 1;
+    std::fill(skipHeads, skipHeads + kMaxLevel - 1, nullptr);
 }
@@ -1,16 +1,28 @@
 #ifndef WORDLIST_H_
 #define WORDLIST_H_
+#include <algorithm>
+#include <string_view>
+#include <utility>
 #include "Word.h"
+#include "Arena.h"
 
 /**
- * The WordList class represents a linked list of Word objects.
+ * The WordList class represents a sorted linked list of Word objects.
+ * The list is indexed as a skip list, so sorted inserts and lookups take O(log n) expected time.
  * It provides various methods for manipulating and accessing the elements of the list.
-
  */
 class WordList {
 private:
+    /**
+     * Maximum number of levels in the skip-list index.
+     * With a promotion probability of 1/4 this comfortably covers billions of words.
+     */
+    static constexpr int kMaxLevel = 16;
+
     /**
      * The WordNode struct represents a node in the WordList containing a Word object and a pointer to the next node.
+     * Besides the level-0 link, a node may carry a tower of express links used by the skip-list index; they are
+     * stored right behind the node in the same allocation, so a node is one flat block without a vtable.
      */
     struct WordNode {
         /**
@@ -24,11 +36,38 @@ private:
         WordNode* next;
 
         /**
-         * Constructor that creates a WordNode with a given Word and optional next node.
+         * Number of levels this node is linked into.
+         */
+        int height;
+
+        /**
+         * Whether the node lives in an Arena and must not be deleted on its own.
+         */
+        bool pooled;
+
+        /**
+         * Constructor that creates an unlinked WordNode by moving a given Word in.
+         * Room for height-1 express links must follow the node.
          * @param aWord The Word object to be stored in the node.
-         * @param next Pointer to the next node (default is nullptr).
+         * @param height The number of levels the node is linked into.
+         * @param pooled Whether the node's memory belongs to an Arena.
+         */
+        WordNode(Word&& aWord, int height, bool pooled)
+            : theWord(std::move(aWord)), next(nullptr), height(height), pooled(pooled) {
+            std::fill(skip(), skip() + height - 1, nullptr);
+        }
+
+        /**
+         * Returns the express links for levels 1 .. height-1, stored right behind the node.
+         * @return The first express link.
+         */
+        WordNode** skip() { return reinterpret_cast<WordNode**>(this + 1); }
+
+        /**
+         * Returns the express links for levels 1 .. height-1, stored right behind the node.
+         * @return The first express link.
          */
-        WordNode(const Word& aWord, WordNode* next = nullptr) : theWord(aWord), next(next) {}
+        WordNode* const* skip() const { return reinterpret_cast<WordNode* const*>(this + 1); }
 
         /**
          * Disable default constructor and other special member functions.
@@ -40,9 +79,9 @@ private:
         WordNode& operator=(WordNode&& other) = delete;
 
         /**
-         * Default destructor.
+         * Default destructor. Not virtual: nodes are only ever destroyed as WordNodes.
          */
-        virtual ~WordNode() = default;
+        ~WordNode() = default;
     };
 
     /**
@@ -61,30 +100,117 @@ private:
     size_t size{ 0 };
 
     /**
-     * Search for the given Word in the list.
-     * @param aWord The Word to look up.
-     * @return A pointer to the WordNode containing the Word, if found; otherwise, nullptr.
+     * Heads of the express levels 1 .. kMaxLevel-1 (level 0 starts at head).
      */
-    WordNode* lookup(const Word& aWord) const;
+    WordNode* skipHeads[kMaxLevel - 1]{};
+
+    /**
+     * Number of levels currently in use.
+     */
+    int levels{ 1 };
+
+    /**
+     * State of the xorshift generator used to pick node heights.
+     */
+    unsigned int seed{ 0x9E3779B9u };
+
+    /**
+     * Arena that new nodes and their characters are allocated from, or nullptr to use the heap.
+     */
+    Arena* arena{ nullptr };
+
+    /**
+     * Allocates a node together with its express links, from the Arena if there is one.
+     * @param aWord The Word to move into the node.
+     * @param height The number of levels the node is linked into.
+     * @return The new, unlinked node.
+     */
+    WordNode* createNode(Word&& aWord, int height);
+
+    /**
+     * Destroys a node created by createNode. Arena memory is left for the Arena to release.
+     * @param nodePtr The node to destroy.
+     */
+    static void destroyNode(WordNode* nodePtr);
+
+    /**
+     * Destroys every node in one pass over the bottom level and resets the list to empty.
+     */
+    void clear();
+
+    /**
+     * Returns a reference to the link of a node at a given level.
+     * @param node The node whose link is wanted, or nullptr for the list header.
+     * @param level The level of the link.
+     * @return A reference to the link so it can be updated in place.
+     */
+    WordNode*& linkAt(WordNode* node, int level);
+
+    /**
+     * Returns the successor of a node at a given level.
+     * @param node The node whose successor is wanted, or nullptr for the list header.
+     * @param level The level to follow.
+     * @return The successor at that level, or nullptr at the end of the level.
+     */
+    WordNode* nextAt(const WordNode* node, int level) const;
+
+    /**
+     * Picks a random tower height for a new node.
+     * @return A height between 1 and kMaxLevel.
+     */
+    int randomHeight();
 
     /**
-     * Add a Word at the front of the list.
-     * @param aWord The Word to add.
+     * Descends the skip-list index, recording the last node before the key on every level.
+     * @param key The key to search for (a Word or a Word::Key), or nullptr to search past the last node.
+     * @param update Receives the predecessor (nullptr for the header) on each level.
+     * @return The first node whose Word is not less than the key, or nullptr.
      */
-    void addFront(const Word& aWord);
+    template <typename Key>
+    WordNode* findPredecessors(const Key* key, WordNode** update);
 
     /**
-     * Add a Word at the back of the list.
-     * @param aWord The Word to add.
+     * Finds the first node whose Word is not less than a given key.
+     * @param key The key to search for (a Word or a Word::Key).
+     * @return The first node not less than the key, or nullptr if every node is smaller.
      */
-    void addBack(const Word& aWord);
+    template <typename Key>
+    WordNode* lowerBound(const Key& key) const;
 
     /**
-     * Add a Word after a specified node in the list.
-     * @param p The node after which the Word should be added.
-     * @param aWord The Word to add.
+     * Links a new node in after the recorded predecessors.
+     * @param update The predecessors on each level, as filled by findPredecessors.
+     * @param aWord The Word to move into the new node.
+     * @return The new node.
      */
-    void addAfter(WordNode* p, const Word& aWord);
+    WordNode* insertAt(WordNode** update, Word&& aWord);
+
+    /**
+     * Unlinks and deletes a node given its recorded predecessors.
+     * @param update The predecessors on each level, as filled by findPredecessors.
+     * @param nodePtr The node to remove.
+     */
+    void unlinkAt(WordNode** update, WordNode* nodePtr);
+
+    /**
+     * Links a node in after the current last node on each of its levels.
+     * @param nodePtr The node to append. It must sort after every node already in the list.
+     * @param last The last node on each level (nullptr for the header); updated to nodePtr on its levels.
+     */
+    void appendNode(WordNode* nodePtr, WordNode** last);
+
+    /**
+     * Search for the given Word in the list.
+     * @param aWord The Word to look up.
+     * @return A pointer to the WordNode containing the Word, if found; otherwise, nullptr.
+     */
+    WordNode* lookup(const Word& aWord) const;
+
+    /**
+     * Appends copies of every Word of another list in one pass, keeping their tower heights.
+     * @param other The list to copy. This list must be empty.
+     */
+    void copyFrom(const WordList& other);
 
     /**
      * Remove a specified node from the list.
@@ -94,6 +220,62 @@ private:
     bool remove(WordNode* nodePtr);
 
 public:
+    /**
+     * Forward iterator over the Words of a WordList in sorted order.
+     */
+    class iterator {
+    private:
+        WordNode* node;
+        friend class WordList;
+    public:
+        explicit iterator(WordNode* node = nullptr) : node(node) {}
+        Word& operator*() const { return node->theWord; }
+        Word* operator->() const { return &node->theWord; }
+        iterator& operator++() { node = node->next; return *this; }
+        bool operator==(const iterator& other) const { return node == other.node; }
+        bool operator!=(const iterator& other) const { return node != other.node; }
+    };
+
+    /**
+     * Forward iterator over the Words of a constant WordList in sorted order.
+     */
+    class const_iterator {
+    private:
+        const WordNode* node;
+        friend class WordList;
+    public:
+        explicit const_iterator(const WordNode* node = nullptr) : node(node) {}
+        const Word& operator*() const { return node->theWord; }
+        const Word* operator->() const { return &node->theWord; }
+        const_iterator& operator++() { node = node->next; return *this; }
+        bool operator==(const const_iterator& other) const { return node == other.node; }
+        bool operator!=(const const_iterator& other) const { return node != other.node; }
+    };
+
+    /**
+     * Appends Words that arrive in sorted order, e.g. when building a list from sorted input, in O(1) each.
+     * It keeps the last node on every level between calls, where WordList::append(Word&&) has to search for them.
+     * The list must not be changed in any other way while an Appender is in use.
+     */
+    class Appender {
+    private:
+        WordList& list;
+        WordNode* last[kMaxLevel]{};
+    public:
+        /**
+         * Constructor that starts appending behind the current last Word of a list.
+         * @param list The list to append to.
+         */
+        explicit Appender(WordList& list);
+
+        /**
+         * Moves a Word into a new node behind the last Word of the list, without comparing it to any Word.
+         * @param aWord The Word to append. It must sort after every Word in the list.
+         * @return A reference to the Word stored in the list. It stays valid until the Word is removed.
+         */
+        Word& append(Word&& aWord);
+    };
+
     /**
      * Default constructor that creates an empty WordList.
      */
@@ -109,7 +291,7 @@ public:
      * Move constructor that creates a new WordList by moving the resources from another WordList.
      * @param list The WordList to move resources from.
      */
-    WordList(WordList&& list);
+    WordList(WordList&& list) noexcept;
 
     /**
      * Copy assignment operator that replaces the contents of the WordList with a copy of another WordList.
@@ -123,7 +305,7 @@ public:
      * @param rhs The WordList to move resources from.
      * @return A reference to the updated WordList.
      */
-    WordList& operator=(WordList&& rhs);
+    WordList& operator=(WordList&& rhs) noexcept;
 
     /**
      * Destructor that cleans up the memory used by the WordList.
@@ -148,6 +330,12 @@ public:
      */
     void print(std::ostream& sout) const;
 
+    /**
+     * Appends the contents of the WordList to an output buffer, in the same format as print(std::ostream&).
+     * @param out The buffer to append to.
+     */
+    void print(OutputBuffer& out) const;
+
     /**
      * Retrieves the Word at the front of the WordList.
      * @return A constant reference to the Word at the front.
@@ -162,16 +350,19 @@ public:
 
     /**
      * Adds a Word to the WordList in sorted order.
+     * If an equal Word is already in the list, the line numbers of aWord are merged into it instead.
      * @param aWord The Word to be added.
+     * @return A reference to the Word stored in the list. It stays valid until the Word is removed.
      */
-    void addSorted(const Word& aWord);
+    Word& addSorted(const Word& aWord);
 
     /**
-     * Adds a Word to the WordList in sorted order, given its string representation and line number.
-     * @param str The string representation of the Word.
+     * Adds a Word to the WordList in sorted order, given its characters and line number.
+     * @param str The characters of the Word.
      * @param lineNum The line number associated with the Word.
+     * @return A reference to the Word stored in the list. It stays valid until the Word is removed.
      */
-    void addSorted(const std::string& str, int lineNum);
+    Word& addSorted(std::string_view str, int lineNum);
 
     /**
      * Removes the Word at the front of the WordList.
@@ -190,6 +381,103 @@ public:
      * @return true if the Word is found in the WordList, false otherwise.
      */
     bool search(const Word& aWord) const;
+
+    /**
+     * Finds a Word in the WordList by its characters.
+     * @param str The characters of the Word to look for.
+     * @return A pointer to the Word, or nullptr if it is not in the list.
+     */
+    const Word* find(std::string_view str) const;
+
+    /**
+     * Seeks to the first Word that is not less than a sequence of characters, in O(log n) expected time.
+     * @param str The characters to seek to.
+     * @return An iterator to the first Word not less than str, or end() if every Word is less.
+     */
+    const_iterator seek(std::string_view str) const;
+
+    /**
+     * Merges another sorted WordList into this one in a single linear pass, leaving the other list empty.
+     * Nodes of the other list are relinked rather than copied, so an Arena they live in must outlive this list.
+     * When both lists hold the same Word,
+     * the other Word's numbers (plus lineOffset) are appended after this Word's numbers.
+     * @param other The WordList to merge in.
+     * @param lineOffset The amount added to each number taken from the other list (default is 0).
+     */
+    void merge(WordList&& other, int lineOffset = 0);
+
+    /**
+     * Merges a copy of another sorted WordList into this one in a single linear pass, leaving the other list as it is.
+     * Only Words missing from this list are copied, into new nodes allocated from this list's Arena. When both lists
+     * hold the same Word, the other Word's numbers (plus lineOffset) are appended after this Word's numbers.
+     * @param other The WordList to merge in.
+     * @param lineOffset The amount added to each number taken from the other list (default is 0).
+     */
+    void merge(const WordList& other, int lineOffset = 0);
+
+    /**
+     * Moves every Word that is not less than a sequence of characters into a new list, in O(log n) expected time
+     * to find the cut plus time linear in the number of Words moved. Nodes are relinked rather than copied.
+     * @param from The characters to cut at.
+     * @return The Words from the cut on, in sorted order; the new list allocates from the same Arena.
+     */
+    WordList split(std::string_view from);
+
+    /**
+     * Moves every Word of another list behind the last Word of this one, leaving the other list empty.
+     * Nodes are relinked rather than copied, so an Arena they live in must outlive this list.
+     * @param other The WordList to append. Every Word in it must sort after every Word in this list.
+     */
+    void append(WordList&& other);
+
+    /**
+     * Moves a Word into a new node behind the last Word of the list, without comparing it to any Word.
+     * Characters the Word keeps in an Arena stay there, so that Arena must outlive this list.
+     * Finding the end takes O(log n) expected time; use an Appender to append many Words in a row.
+     * @param aWord The Word to append. It must sort after every Word in this list.
+     * @return A reference to the Word stored in the list. It stays valid until the Word is removed.
+     */
+    Word& append(Word&& aWord);
+
+    /**
+     * Moves every Word into new nodes allocated one after another from an Arena, in sorted order, so a walk over
+     * the list reads memory front to back instead of jumping between nodes allocated in insertion order.
+     * The old nodes are destroyed; memory of an Arena they lived in is released with that Arena.
+     * Pointers and references to the Words are invalidated.
+     * @param target The Arena for the new nodes; the list allocates from it from now on.
+     */
+    void compact(Arena& target);
+
+    /**
+     * Sets the Arena that nodes and characters added from now on are allocated from.
+     * The Arena must outlive every node allocated from it; nodes already in the list are not moved.
+     * @param newArena The Arena to use, or nullptr to allocate from the heap.
+     */
+    void setArena(Arena* newArena);
+
+    /**
+     * Returns an iterator to the first Word of the WordList.
+     * @return An iterator to the first Word.
+     */
+    iterator begin();
+
+    /**
+     * Returns an iterator past the last Word of the WordList.
+     * @return An iterator past the last Word.
+     */
+    iterator end();
+
+    /**
+     * Returns a constant iterator to the first Word of the WordList.
+     * @return A constant iterator to the first Word.
+     */
+    const_iterator begin() const;
+
+    /**
+     * Returns a constant iterator past the last Word of the WordList.
+     * @return A constant iterator past the last Word.
+     */
+    const_iterator end() const;
 };
 
 #endif /* WORDLIST_H_ */
@@ -0,0 +1,126 @@
+#include <cstring>
+#include <cstdint>
+#include "WordTable.h"
+
+/**
+ * Computes the hash of a sequence of bytes, eight bytes at a time.
+ * @param key Pointer to the first byte of the word.
+ * @param length The number of bytes in the word.
+ * @return The hash of the word.
+ */
+size_t WordTable::hashOf(const char* key, size_t length) {
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    uint64_t h = length * multiplier;
+    while (length >= 8) {
+        uint64_t chunk;
+        std::memcpy(&chunk, key, 8);
+        h = (h ^ chunk) * multiplier;
+        h ^= h >> 29;
+        key += 8;
+        length -= 8;
+    }
+    if (length > 0) {
+        uint64_t chunk = 0;
+        std::memcpy(&chunk, key, length);
+        h = (h ^ chunk) * multiplier;
+    }
+    // Final avalanche so the low bits used for the slot index depend on every byte
+    h ^= h >> 32;
+    h *= multiplier;
+    h ^= h >> 29;
+    return static_cast<size_t>(h);
+}
+
+/**
+ * Looks up a word by its bytes.
+ * @param key Pointer to the first byte of the word.
+ * @param length The number of bytes in the word.
+ * @param hash The hash of the word, as returned by hashOf.
+ * @return A pointer to the stored Word, or nullptr if the word is not in the table.
+ */
+Word* WordTable::find(const char* key, size_t length, size_t hash) const {
+    uint32_t id;
+    return find(key, length, hash, id);
+}
+
+/**
+ * Looks up a word by its bytes and also returns the id it was inserted with.
+ * @param key Pointer to the first byte of the word.
+ * @param length The number of bytes in the word.
+ * @param hash The hash of the word, as returned by hashOf.
+ * @param id Receives the id of the word if it is found.
+ * @return A pointer to the stored Word, or nullptr if the word is not in the table.
+ */
+Word* WordTable::find(const char* key, size_t length, size_t hash, uint32_t& id) const {
+    if (slots.empty()) {
+        return nullptr;
+    }
+    size_t mask = slots.size() - 1;
+    uint32_t tag = static_cast<uint32_t>(hash);
+    for (size_t i = hash & mask; slots[i].word != nullptr; i = (i + 1) & mask) {
+        if (slots[i].hash == tag) {
+            const Word* stored = slots[i].word;
+            if (stored->size() == length && std::memcmp(stored->c_str(), key, length) == 0) {
+                id = slots[i].id;
+                return slots[i].word;
+            }
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * Adds a Word to the table, growing it first if it would become more than 70% full.
+ * @param word The Word to add.
+ * @param hash The hash of the Word's characters, as returned by hashOf.
+ * @param id An id for the Word, returned by later lookups.
+ */
+void WordTable::insert(Word* word, size_t hash, uint32_t id) {
+    if ((count + 1) * 10 > slots.size() * 7) {
+        grow();
+    }
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].word != nullptr) {
+        i = (i + 1) & mask;
+    }
+    slots[i].hash = static_cast<uint32_t>(hash);
+    slots[i].id = id;
+    slots[i].word = word;
+    count++;
+}
+
+/**
+ * Removes every entry from the table and releases the slot array.
+ */
+void WordTable::clear() {
+    slots.clear();
+    slots.shrink_to_fit();
+    count = 0;
+}
+
+/**
+ * Returns the number of Words in the table.
+ * @return The number of Words in the table.
+ */
+size_t WordTable::size() const {
+    return count;
+}
+
+/**
+ * Doubles the number of slots (starting at 1024) and re-inserts every Word using its cached hash.
+ */
+void WordTable::grow() {
+    std::vector<Slot> old(slots.empty() ? 1024 : slots.size() * 2, Slot{ 0, 0, nullptr });
+    old.swap(slots);
+    size_t mask = slots.size() - 1;
+    for (const Slot& slot : old) {
+        if (slot.word != nullptr) {
+            size_t i = slot.hash & mask;
+            while (slots[i].word != nullptr) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = slot;
+        }
+    }
+}
@@ -0,0 +1,144 @@
+#ifndef WORDTABLE_H_
+#define WORDTABLE_H_
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Word.h"
+
+/**
+ * The WordTable class is an open-addressing hash table that maps the bytes of a word to the Word stored in a WordList.
+ * It does not own the Words it points to; the owning lists must keep their nodes in place while the table is in use.
+ * Collisions are resolved by linear probing over a power-of-two sized slot array.
+ */
+class WordTable {
+private:
+    /**
+     * A slot of the table: the low 32 bits of the word's hash, an id the owner assigned to the word,
+     * and a pointer to it (nullptr for an empty slot).
+     * The low hash bits are all grow() needs while the table has at most 2^32 slots.
+     */
+    struct Slot {
+        uint32_t hash;
+        uint32_t id;
+        Word* word;
+    };
+
+    /**
+     * The slot array. Its size is always zero or a power of two.
+     */
+    std::vector<Slot> slots;
+
+    /**
+     * The number of occupied slots.
+     */
+    size_t count{ 0 };
+
+    /**
+     * Doubles the number of slots and re-inserts every Word.
+     */
+    void grow();
+
+    /**
+     * Asks the CPU to start loading the cache line at an address, without waiting for it.
+     * @param address The address to load.
+     */
+    static void prefetchAddress(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+        __builtin_prefetch(address);
+#else
+        (void)address;
+#endif
+    }
+
+public:
+    /**
+     * Default constructor that creates an empty table.
+     */
+    WordTable() = default;
+
+    /**
+     * Computes the hash of a sequence of bytes.
+     * @param key Pointer to the first byte of the word.
+     * @param length The number of bytes in the word.
+     * @return The hash of the word.
+     */
+    static size_t hashOf(const char* key, size_t length);
+
+    /**
+     * Looks up a word by its bytes.
+     * @param key Pointer to the first byte of the word.
+     * @param length The number of bytes in the word.
+     * @param hash The hash of the word, as returned by hashOf.
+     * @return A pointer to the stored Word, or nullptr if the word is not in the table.
+     */
+    Word* find(const char* key, size_t length, size_t hash) const;
+
+    /**
+     * Looks up a word by its bytes and also returns the id it was inserted with.
+     * @param key Pointer to the first byte of the word.
+     * @param length The number of bytes in the word.
+     * @param hash The hash of the word, as returned by hashOf.
+     * @param id Receives the id of the word if it is found.
+     * @return A pointer to the stored Word, or nullptr if the word is not in the table.
+     */
+    Word* find(const char* key, size_t length, size_t hash, uint32_t& id) const;
+
+    /**
+     * First prefetch step of a batched lookup: starts loading the home slot of a hash.
+     * @param hash The hash of the word about to be looked up.
+     */
+    void prefetchSlot(size_t hash) const {
+        if (!slots.empty()) {
+            prefetchAddress(&slots[hash & (slots.size() - 1)]);
+        }
+    }
+
+    /**
+     * Second prefetch step: starts loading the Word in the home slot, if the slot holds the hash.
+     * Call it once the slot has had time to arrive (see prefetchSlot).
+     * @param hash The hash of the word about to be looked up.
+     */
+    void prefetchWord(size_t hash) const {
+        if (!slots.empty()) {
+            const Slot& home = slots[hash & (slots.size() - 1)];
+            if (home.hash == static_cast<uint32_t>(hash) && home.word != nullptr) {
+                prefetchAddress(home.word);
+            }
+        }
+    }
+
+    /**
+     * Third prefetch step: starts loading the characters of the Word in the home slot.
+     * Call it once the Word has had time to arrive (see prefetchWord).
+     * @param hash The hash of the word about to be looked up.
+     */
+    void prefetchCharacters(size_t hash) const {
+        if (!slots.empty()) {
+            const Slot& home = slots[hash & (slots.size() - 1)];
+            if (home.hash == static_cast<uint32_t>(hash) && home.word != nullptr) {
+                prefetchAddress(home.word->c_str());
+            }
+        }
+    }
+
+    /**
+     * Adds a Word to the table. The Word must not already be in the table.
+     * @param word The Word to add.
+     * @param hash The hash of the Word's characters, as returned by hashOf.
+     * @param id An id for the Word, returned by later lookups (default is 0).
+     */
+    void insert(Word* word, size_t hash, uint32_t id = 0);
+
+    /**
+     * Removes every entry from the table.
+     */
+    void clear();
+
+    /**
+     * Returns the number of Words in the table.
+     * @return The number of Words in the table.
+     */
+    size_t size() const;
+};
+
+#endif /* WORDTABLE_H_ */
@@ -4,6 +4,8 @@
  */
 
 #include <iostream>
+#include <limits>
+#include <stdexcept>
 #include "Dictionary.h"
 
 using std::cout;
@@ -13,26 +15,49 @@ using std::string;
 /**
  * @brief The main function of the program.
  *
- * This function prompts the user to input the name of a text file. It then creates a Dictionary object using the file,
- * processes the file, and prints the result.
+ * This function takes the name of a text file from the command line or, if there is none, prompts the user for it.
+ * It then creates a Dictionary object from the file and prints the result. The name "-" reads the text from
+ * standard input instead, as it arrives, until end of file.
  *
- * @return int - Returns 0 if the program runs successfully.
+ * @return int - Returns 0 if the program runs successfully, 1 if the file cannot be read.
  */
-int main() {
-    // Prompt the user to enter the name of the input text file
-    cout << "Enter the name of input text file: " ;
-
-    // Read the filename input by the user
+int main(int argc, char* argv[]) {
     string filename;
-    cin >> filename;
-
-    // Create a Dictionary object using the file specified by the user
-    Dictionary dictionary(filename);
-
-    // Process the file and print the results
-    dictionary.print(cout);
+    if (argc > 1) {
+        // Take the name of the input text file from the command line
+        filename = argv[1];
+    } else {
+        // Prompt the user to enter the name of the input text file
+        cout << "Enter the name of input text file: " ;
+
+        // Read the filename input by the user
+        cin >> filename;
+        if (filename == "-") {
+            // The text starts on the line after the filename
+            cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+    }
+
+    try {
+        if (filename == "-") {
+            // Index standard input chunk by chunk
+            Dictionary dictionary;
+            dictionary.ingest(cin);
+            dictionary.finish();
+            dictionary.print(cout);
+            return 0;
+        }
+
+        // Create a Dictionary object using the file specified by the user
+        Dictionary dictionary(filename);
+
+        // Process the file and print the results
+        dictionary.print(cout);
+    } catch (const std::runtime_error& error) {
+        cout << error.what() << std::endl;
+        return 1;
+    }
 
     // End the program
     return 0;
 }
-
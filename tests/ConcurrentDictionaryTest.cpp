@@ -0,0 +1,119 @@
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ConcurrentDictionary.h"
+#include "Dictionary.h"
+#include "TestSupport.h"
+
+/**
+ * Checks that words become visible on publication only, and that older snapshots keep what they saw.
+ */
+static void checkPublication() {
+    ConcurrentDictionary dictionary(DictionaryOptions(), size_t(1) << 30);
+    dictionary.processWord("apple", 1);
+    dictionary.processWord("banana", 1);
+    CHECK(!dictionary.contains("apple"));
+    CHECK(dictionary.snapshot().size() == 0);
+
+    dictionary.publish();
+    ConcurrentDictionary::Snapshot before = dictionary.snapshot();
+    CHECK(before.contains("apple") && before.contains("banana"));
+    CHECK(before.size() == 2);
+
+    dictionary.processWord("apple", 2);
+    dictionary.processWord("cherry", 2);
+    dictionary.publish();
+    CHECK(dictionary.frequency("apple") == 2);
+    CHECK(dictionary.contains("cherry"));
+    CHECK(dictionary.snapshot().size() == 3);
+
+    // The old snapshot still sees the version it pinned
+    CHECK(before.frequency("apple") == 1);
+    CHECK(!before.contains("cherry"));
+    CHECK(before.size() == 2);
+    const NumList* lines = before.lines("apple");
+    CHECK(lines != nullptr && lines->getSize() == 1);
+}
+
+/**
+ * Checks that a normalized word is published in the bucket it was stored in, not the one of its raw token.
+ */
+static void checkNormalizedPublication() {
+    DictionaryOptions options;
+    options.normalization = Normalization::StripPunctuation | Normalization::CaseFold;
+    ConcurrentDictionary dictionary(options, size_t(1) << 30);
+    dictionary.processWord("(the", 1);
+    dictionary.processWord("Zebra", 1);
+    dictionary.processWord("...", 1);
+    dictionary.publish();
+    CHECK(dictionary.contains("the"));
+    CHECK(dictionary.frequency("zebra") == 1);
+    CHECK(dictionary.snapshot().size() == 2);
+}
+
+/**
+ * Checks that ingested text is published by finish and matches a Dictionary built from the same text.
+ */
+static void checkIngest() {
+    std::string text = generateCorpus(2000, 11);
+    DictionaryOptions options;
+    options.normalization = Normalization::StripPunctuation | Normalization::CaseFold;
+    ConcurrentDictionary dictionary(options, size_t(1) << 30);
+    Dictionary expected(options);
+    for (size_t start = 0; start < text.size(); start += 997) {
+        dictionary.ingest(std::string_view(text).substr(start, 997));
+        expected.ingest(std::string_view(text).substr(start, 997));
+    }
+    CHECK(dictionary.snapshot().size() == 0);
+    dictionary.finish();
+    expected.finish();
+    CHECK(dictionary.snapshot().size() == expected.size());
+    CHECK(printed(dictionary.snapshot()) == printed(expected));
+    CHECK(dictionary.frequency("the") == expected.frequency("the"));
+}
+
+/**
+ * Checks that readers running alongside the writer always see a consistent prefix of what was added.
+ */
+static void checkConcurrentReaders() {
+    const int kWords = 20000;
+    ConcurrentDictionary dictionary(DictionaryOptions(), 64);
+    std::atomic<bool> done{ false };
+    std::atomic<int> inconsistent{ 0 };
+
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; r++) {
+        readers.emplace_back([&]() {
+            size_t lastSize = 0;
+            while (!done.load()) {
+                ConcurrentDictionary::Snapshot snapshot = dictionary.snapshot();
+                size_t size = snapshot.size();
+                // Words are added in order and published whole, so a snapshot holds exactly the first size words
+                if (size < lastSize || (size > 0 && !snapshot.contains("w" + std::to_string(size - 1))) ||
+                    snapshot.contains("w" + std::to_string(size))) {
+                    ++inconsistent;
+                }
+                lastSize = size;
+            }
+        });
+    }
+    for (int i = 0; i < kWords; i++) {
+        dictionary.processWord("w" + std::to_string(i), i + 1);
+    }
+    dictionary.publish();
+    done.store(true);
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    CHECK(inconsistent.load() == 0);
+    CHECK(dictionary.snapshot().size() == static_cast<size_t>(kWords));
+}
+
+int main() {
+    checkPublication();
+    checkNormalizedPublication();
+    checkIngest();
+    checkConcurrentReaders();
+    return testResult();
+}
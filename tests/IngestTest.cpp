@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include "Dictionary.h"
+#include "DictionarySnapshot.h"
+#include "TestSupport.h"
+
+/*
+ * Builds the same text every way the library offers and checks each result against the baseline:
+ * a Dictionary read line by line with IngestMode::Stream.
+ */
+
+/** The normalization used by the normalized variants of every check */
+static const Normalization kNormalized = Normalization::StripPunctuation | Normalization::CaseFold | Normalization::Stem;
+
+/**
+ * Returns the settings for one build.
+ * @param mode How the file is read.
+ * @param threads The number of threads.
+ * @param normalization How tokens are normalized.
+ * @return The settings.
+ */
+static DictionaryOptions optionsFor(IngestMode mode, unsigned threads, Normalization normalization) {
+    DictionaryOptions options;
+    options.mode = mode;
+    options.threads = threads;
+    options.normalization = normalization;
+    return options;
+}
+
+/**
+ * Checks every IngestMode, with and without compressed postings and with small partitions, against the baseline.
+ * @param path The text file.
+ * @param normalization How tokens are normalized.
+ */
+static void checkIngestModes(const std::string& path, Normalization normalization) {
+    Dictionary baseline(path, optionsFor(IngestMode::Stream, 0, normalization));
+    std::string expected = printed(baseline);
+    CHECK(!expected.empty());
+
+    for (IngestMode mode : { IngestMode::Mapped, IngestMode::Parallel, IngestMode::Bulk }) {
+        for (unsigned threads : { 1u, 4u }) {
+            DictionaryOptions options = optionsFor(mode, threads, normalization);
+            CHECK(printed(Dictionary(path, options)) == expected);
+
+            options.compressPostings = true;
+            options.bucketSplitThreshold = 64;
+            options.bucketPrefixBytes = 2;
+            Dictionary compressed(path, options);
+            CHECK(printed(compressed) == expected);
+            const Word* word = compressed.find(compressed.normalize("the"));
+            CHECK(word != nullptr && word->getNumberList().isCompressed());
+        }
+    }
+
+    // Words are found through the hash index with the same counts as in the baseline
+    Dictionary parallel(path, optionsFor(IngestMode::Parallel, 2, normalization));
+    for (const char* token : { "the", "The", "queries", "zebra", "antidisestablishmentarianism", "missing" }) {
+        std::string word = baseline.normalize(token);
+        const Word* expectedWord = baseline.find(word);
+        const Word* found = parallel.find(word);
+        CHECK((found == nullptr) == (expectedWord == nullptr));
+        if (found != nullptr && expectedWord != nullptr) {
+            CHECK(found->getFrequency() == expectedWord->getFrequency());
+            CHECK(parallel.frequency(word) == expectedWord->getFrequency());
+        }
+    }
+}
+
+/**
+ * Checks that a text fed to ingest in uneven chunks, cutting words and lines, gives the baseline.
+ * @param path The text file.
+ * @param text The contents of the file.
+ */
+static void checkChunkedIngest(const std::string& path, const std::string& text) {
+    Dictionary baseline(path, optionsFor(IngestMode::Stream, 0, Normalization::Verbatim));
+    Dictionary chunked;
+    for (size_t start = 0, size = 1; start < text.size(); start += size, size = size * 3 % 9973 + 1) {
+        chunked.ingest(std::string_view(text).substr(start, size));
+    }
+    chunked.finish();
+    CHECK(printed(chunked) == printed(baseline));
+}
+
+/**
+ * Checks saved snapshots and snapshots built with and without spilling against the baseline.
+ * @param path The text file.
+ * @param normalization How tokens are normalized.
+ */
+static void checkSnapshots(const std::string& path, Normalization normalization) {
+    Dictionary baseline(path, optionsFor(IngestMode::Stream, 0, normalization));
+    std::string saved = tempPath("saved.snapshot");
+    baseline.save(saved);
+    {
+        DictionarySnapshot snapshot(saved);
+        CHECK(printed(snapshot) == printed(baseline));
+        std::string word = baseline.normalize("the");
+        CHECK(snapshot.frequency(word) == baseline.find(word)->getFrequency());
+        CHECK(!snapshot.contains("missing"));
+    }
+
+    // Everything in memory, then runs of one chunk each: more than SpillRun::kMaxFanIn, so merged in two passes
+    std::string built = tempPath("built.snapshot");
+    for (size_t budget : { size_t(256) << 20, size_t(1 << 20), size_t(1) }) {
+        DictionaryOptions options = optionsFor(IngestMode::Stream, 2, normalization);
+        options.memoryBudget = budget;
+        Dictionary::buildSnapshot(path, built, options);
+        CHECK(readFile(built) == readFile(saved));
+    }
+    std::remove(saved.c_str());
+    std::remove(built.c_str());
+}
+
+/**
+ * Checks that Dictionaries built from two halves of a text and merged give the baseline.
+ * @param path The text file.
+ * @param text The contents of the file.
+ */
+static void checkMerge(const std::string& path, const std::string& text) {
+    size_t cut = text.find('\n', text.size() / 3) + 1;
+    int firstLines = static_cast<int>(std::count(text.begin(), text.begin() + cut, '\n'));
+    std::string firstPath = tempPath("first.txt");
+    std::string secondPath = tempPath("second.txt");
+    writeFile(firstPath, text.substr(0, cut));
+    writeFile(secondPath, text.substr(cut));
+
+    std::string expected = printed(Dictionary(path, optionsFor(IngestMode::Stream, 0, Normalization::Verbatim)));
+    for (unsigned threads : { 1u, 4u }) {
+        DictionaryOptions firstOptions = optionsFor(IngestMode::Mapped, 0, Normalization::Verbatim);
+        DictionaryOptions secondOptions = firstOptions;
+        secondOptions.bucketSplitThreshold = 32; // Partitioned differently from the target
+        firstOptions.compressPostings = threads == 1;
+        secondOptions.compressPostings = threads == 4;
+        Dictionary first(firstPath, firstOptions);
+        Dictionary second(secondPath, secondOptions);
+        std::string secondBefore = printed(second);
+        first.merge(second, firstLines, threads);
+        CHECK(printed(first) == expected);
+        CHECK(printed(second) == secondBefore);
+
+        // Copied line numbers follow the target's setting
+        bool encodedAsTarget = true;
+        for (size_t bucket = 0; bucket < Dictionary::kBucketCount; bucket++) {
+            for (const Word& word : first.getBucket(bucket)) {
+                encodedAsTarget &= word.getNumberList().isCompressed() == firstOptions.compressPostings;
+            }
+        }
+        CHECK(encodedAsTarget);
+    }
+
+    // Both halves left unfinished, each holding back the last word of its text
+    Dictionary first;
+    Dictionary second;
+    first.ingest(std::string_view(text).substr(0, cut - 1));
+    second.ingest(std::string_view(text).substr(cut));
+    first.merge(second, firstLines);
+    CHECK(printed(first) == expected);
+
+    std::remove(firstPath.c_str());
+    std::remove(secondPath.c_str());
+}
+
+int main() {
+    std::string text = generateCorpus(130000, 7);
+    std::string path = tempPath("corpus.txt");
+    writeFile(path, text);
+
+    checkIngestModes(path, Normalization::Verbatim);
+    checkIngestModes(path, kNormalized);
+    checkChunkedIngest(path, text);
+    checkSnapshots(path, Normalization::Verbatim);
+    checkSnapshots(path, kNormalized);
+    checkMerge(path, text);
+
+    std::remove(path.c_str());
+    return testResult();
+}
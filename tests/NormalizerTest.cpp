@@ -0,0 +1,74 @@
+#include <string>
+#include <string_view>
+#include "Normalizer.h"
+#include "TestSupport.h"
+
+/**
+ * Normalizes a token with steps chosen at run time, through dispatch.
+ * @param steps The Normalization steps.
+ * @param token The token.
+ * @return The normalized word.
+ */
+static std::string normalized(Normalization steps, std::string_view token) {
+    std::string scratch;
+    return std::string(Normalizer::dispatch(steps, [&](auto constant) {
+        return Normalizer::apply<decltype(constant)::value>(token, scratch);
+    }));
+}
+
+/**
+ * Checks each step on its own.
+ */
+static void checkSteps() {
+    CHECK(Normalizer::stripPunctuation("(the,") == "the");
+    CHECK(Normalizer::stripPunctuation("don't") == "don't");
+    CHECK(Normalizer::stripPunctuation("\"well-known\".") == "well-known");
+    CHECK(Normalizer::stripPunctuation("--").empty());
+    CHECK(Normalizer::stripPunctuation("").empty());
+
+    std::string scratch;
+    CHECK(Normalizer::foldCase("The", scratch) == "the");
+    CHECK(Normalizer::foldCase("MiXeD-42", scratch) == "mixed-42");
+    std::string_view lower = "plain";
+    CHECK(Normalizer::foldCase(lower, scratch).data() == lower.data()); // Nothing to fold: no copy
+
+    struct {
+        const char* token;
+        const char* stem;
+    } stems[] = {
+        { "queries", "query" }, { "cats", "cat" },       { "horses", "horse" },   { "is", "is" },
+        { "was", "was" },       { "bus", "bus" },         { "corpus", "corpus" },  { "glass", "glass" },
+        { "goes", "goes" },     { "trees", "trees" },     { "aies", "aies" },      { "species", "specy" },
+        { "dog", "dog" },       { "Cats", "Cat" },        { "QUERIES", "QUERIES" },
+    };
+    for (const auto& test : stems) {
+        CHECK(Normalizer::stem(test.token, scratch) == test.stem);
+    }
+}
+
+/**
+ * Checks combined steps, which run in the order strip, fold, stem, through apply and dispatch.
+ */
+static void checkCombinations() {
+    const Normalization all = Normalization::StripPunctuation | Normalization::CaseFold | Normalization::Stem;
+    CHECK(normalized(Normalization::Verbatim, "(Queries,") == "(Queries,");
+    CHECK(normalized(Normalization::StripPunctuation, "(Queries,") == "Queries");
+    CHECK(normalized(Normalization::CaseFold, "(Queries,") == "(queries,");
+    CHECK(normalized(Normalization::Stem, "(Queries,") == "(Queries,");
+    CHECK(normalized(Normalization::StripPunctuation | Normalization::Stem, "(queries,") == "query");
+    CHECK(normalized(Normalization::CaseFold | Normalization::Stem, "QUERIES") == "query");
+    CHECK(normalized(all, "(Queries,") == "query");
+    CHECK(normalized(all, "\"CATS!\"") == "cat");
+    CHECK(normalized(all, "...").empty());
+
+    // Verbatim hands the token back untouched, without copying it
+    std::string scratch;
+    std::string_view token = "(The";
+    CHECK(Normalizer::apply<0>(token, scratch).data() == token.data());
+}
+
+int main() {
+    checkSteps();
+    checkCombinations();
+    return testResult();
+}
@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <climits>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "NumList.h"
+#include "TestSupport.h"
+
+/**
+ * Builds a NumList from values.
+ * @param values The elements in order.
+ * @return The list.
+ */
+static NumList listOf(const std::vector<int>& values) {
+    NumList list;
+    for (int value : values) {
+        list.append(value);
+    }
+    return list;
+}
+
+/**
+ * Returns the elements of a NumList.
+ * @param list The list.
+ * @return The elements in order.
+ */
+static std::vector<int> valuesOf(const NumList& list) {
+    return std::vector<int>(list.begin(), list.end());
+}
+
+/**
+ * Returns increasing values with gaps drawn from a linear congruential generator.
+ * @param count The number of values.
+ * @param maxGap The largest gap between two values.
+ * @param seed The generator seed.
+ * @return The values.
+ */
+static std::vector<int> increasing(int count, int maxGap, uint32_t seed) {
+    std::vector<int> values;
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        value += 1 + static_cast<int>((seed >> 8) % static_cast<uint32_t>(maxGap));
+        values.push_back(value);
+    }
+    return values;
+}
+
+/**
+ * Checks that compressing and decompressing keeps the elements, and that compressed lists still append and index.
+ */
+static void checkCompression() {
+    // Small deltas, large deltas, negative steps and the extremes of int all survive the zigzag varint encoding
+    std::vector<std::vector<int>> cases = {
+        {},
+        { 7 },
+        increasing(3, 2, 1),
+        increasing(1000, 3, 2),
+        increasing(1000, 1 << 20, 3),
+        { 5, 3, 3, -2, 1000000, -1000000, INT_MAX, INT_MIN, 0 },
+    };
+    for (const std::vector<int>& values : cases) {
+        NumList list = listOf(values);
+        list.compress();
+        CHECK(list.isCompressed());
+        CHECK(list.getSize() == static_cast<int>(values.size()));
+        CHECK(valuesOf(list) == values);
+        for (size_t i = 0; i < values.size(); i++) {
+            CHECK(list.get(static_cast<int>(i)) == values[i]);
+        }
+
+        std::vector<int> more = values;
+        list.append(42);
+        list.append(43);
+        more.push_back(42);
+        more.push_back(43);
+        CHECK(valuesOf(list) == more);
+        CHECK(list.contains(42) && !list.contains(44));
+
+        NumList copy = list;
+        CHECK(copy.isCompressed() && valuesOf(copy) == more);
+        list.decompress();
+        CHECK(!list.isCompressed());
+        CHECK(valuesOf(list) == more);
+    }
+
+    // Large increasing lists take much less room compressed
+    NumList dense = listOf(increasing(10000, 4, 4));
+    size_t plainBytes = dense.heapBytes();
+    dense.compress();
+    CHECK(dense.heapBytes() * 2 < plainBytes);
+}
+
+/**
+ * Checks encodeTo and assignEncoded round trips, and appending lists with an offset in both modes.
+ */
+static void checkEncodingAndAppend() {
+    std::vector<int> values = increasing(500, 100, 5);
+    for (bool compress : { false, true }) {
+        NumList list = listOf(values);
+        if (compress) {
+            list.compress();
+        }
+        std::string encoded;
+        list.encodeTo(encoded);
+        NumList decoded;
+        decoded.assignEncoded(reinterpret_cast<const unsigned char*>(encoded.data()), static_cast<int>(encoded.size()),
+                              list.getSize());
+        CHECK(valuesOf(decoded) == values);
+
+        std::vector<int> tail = increasing(300, 50, 6);
+        for (bool compressTail : { false, true }) {
+            NumList joined = list;
+            NumList other = listOf(tail);
+            if (compressTail) {
+                other.compress();
+            }
+            joined.append(other, values.back());
+            std::vector<int> expected = values;
+            for (int value : tail) {
+                expected.push_back(value + values.back());
+            }
+            CHECK(valuesOf(joined) == expected);
+            CHECK(joined.isCompressed() == compress);
+        }
+    }
+}
+
+/**
+ * Checks intersections and unions of a pair of lists against the standard algorithms.
+ * @param a The first list's elements, increasing.
+ * @param b The second list's elements, increasing.
+ */
+static void checkSetOperations(const std::vector<int>& a, const std::vector<int>& b) {
+    std::vector<int> both;
+    std::vector<int> either;
+    std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(both));
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::back_inserter(either));
+    for (int compressed = 0; compressed < 4; compressed++) {
+        NumList first = listOf(a);
+        NumList second = listOf(b);
+        if (compressed & 1) {
+            first.compress();
+        }
+        if (compressed & 2) {
+            second.compress();
+        }
+        CHECK(valuesOf(NumList::intersectionOf(first, second)) == both);
+        CHECK(valuesOf(NumList::intersectionOf(second, first)) == both);
+        CHECK(valuesOf(first & second) == both);
+        CHECK(valuesOf(NumList::unionOf(first, second)) == either);
+        CHECK(valuesOf(first | second) == either);
+    }
+}
+
+/**
+ * Checks intersections and unions of balanced and skewed pairs, which take the merge and galloping paths,
+ * and of several lists at once.
+ */
+static void checkIntersection() {
+    checkSetOperations({}, {});
+    checkSetOperations({}, { 1, 2, 3 });
+    checkSetOperations({ 1, 2, 3 }, { 1, 2, 3 });
+    checkSetOperations({ 1, 3, 5 }, { 2, 4, 6 });
+    checkSetOperations(increasing(2000, 3, 7), increasing(2000, 3, 8));
+    checkSetOperations(increasing(10, 400, 9), increasing(5000, 2, 10));
+    checkSetOperations({ 1, 9999 }, increasing(10000, 1, 11));
+
+    std::vector<std::vector<int>> values = { increasing(3000, 2, 12), increasing(3000, 2, 13),
+                                             increasing(200, 30, 14), increasing(3000, 2, 15) };
+    std::vector<NumList> lists;
+    for (const auto& v : values) {
+        lists.push_back(listOf(v));
+    }
+    lists[1].compress();
+    std::vector<const NumList*> pointers;
+    std::vector<int> both = values[0];
+    std::vector<int> either;
+    for (size_t i = 0; i < lists.size(); i++) {
+        pointers.push_back(&lists[i]);
+        std::vector<int> next;
+        std::set_intersection(both.begin(), both.end(), values[i].begin(), values[i].end(), std::back_inserter(next));
+        both.swap(next);
+        next.clear();
+        std::set_union(either.begin(), either.end(), values[i].begin(), values[i].end(), std::back_inserter(next));
+        either.swap(next);
+    }
+    CHECK(!both.empty());
+    CHECK(valuesOf(NumList::intersectionOf(pointers)) == both);
+    CHECK(valuesOf(NumList::unionOf(pointers)) == either);
+    CHECK(NumList::intersectionOf(std::vector<const NumList*>()).empty());
+}
+
+int main() {
+    checkCompression();
+    checkEncodingAndAppend();
+    checkIntersection();
+    return testResult();
+}
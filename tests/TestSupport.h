@@ -0,0 +1,130 @@
+#ifndef TESTSUPPORT_H_
+#define TESTSUPPORT_H_
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+/**
+ * Returns the number of failed checks in the running test program.
+ * @return A reference to the counter.
+ */
+inline int& failedChecks() {
+    static int failures = 0;
+    return failures;
+}
+
+/** Reports a failed condition with its location and carries on, so one run shows every failure */
+#define CHECK(condition)                                                                        \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            ++failedChecks();                                                                   \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition "\n";     \
+        }                                                                                       \
+    } while (0)
+
+/**
+ * Returns the exit status of a test program and reports the number of failed checks.
+ * @return 0 if every check passed, 1 otherwise.
+ */
+inline int testResult() {
+    if (failedChecks() != 0) {
+        std::cerr << failedChecks() << " check(s) failed\n";
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * Returns a path in the system temporary directory that is unique to this process.
+ * @param name The name of the file within the test.
+ * @return The path.
+ */
+inline std::string tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() /
+            ("textdict-test-" + std::to_string(getpid()) + "-" + name)).string();
+}
+
+/**
+ * Writes a string to a file, replacing its contents.
+ * @param path The name of the file.
+ * @param text The contents.
+ */
+inline void writeFile(const std::string& path, const std::string& text) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << text;
+}
+
+/**
+ * Reads a whole file.
+ * @param path The name of the file.
+ * @return The contents, or an empty string if the file cannot be read.
+ */
+inline std::string readFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+/**
+ * Prints anything with a print(std::ostream&) member into a string.
+ * @param printable The object to print.
+ * @return What it printed.
+ */
+template <typename Printable>
+std::string printed(const Printable& printable) {
+    std::ostringstream out;
+    printable.print(out);
+    return out.str();
+}
+
+/**
+ * Generates a text with a skewed mix of words: repeated and rare words, upper and lower case, words
+ * longer than the inline buffer of a Word, punctuation, digits, blank lines and runs of whitespace.
+ * The same seed always gives the same text.
+ * @param lines The number of lines.
+ * @param seed The seed of the generator.
+ * @return The text; its last line has no line break.
+ */
+inline std::string generateCorpus(int lines, uint32_t seed) {
+    static const char* const kWords[] = {
+        "the", "The", "a", "of", "and", "to", "in", "is", "was", "queries", "query", "classes",
+        "(the", "the,", "don't", "Dictionary", "dictionary.", "interdisciplinary", "internationalization",
+        "antidisestablishmentarianism", "42", "3.14", "#tag", "_under", "zebra", "Zebra", "yak", "x",
+        "mississippi", "running", "runs", "bus", "glass", "ponies", "\"quoted\"", "end."
+    };
+    const size_t wordCount = sizeof(kWords) / sizeof(kWords[0]);
+    uint32_t state = seed;
+    auto next = [&state]() {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    };
+    std::string text;
+    for (int line = 0; line < lines; ++line) {
+        int words = next() % 13;
+        for (int i = 0; i < words; ++i) {
+            if (i > 0) {
+                text += next() % 7 == 0 ? "  \t" : " ";
+            }
+            uint32_t pick = next();
+            if (pick % 5 == 0) {
+                // A rare word, so most buckets see many distinct words
+                text += static_cast<char>('a' + pick % 26);
+                text += "w" + std::to_string(pick % 5000);
+            } else {
+                text += kWords[(pick % wordCount) * (pick % wordCount) / wordCount];
+            }
+        }
+        if (line + 1 < lines) {
+            text += '\n';
+        }
+    }
+    return text;
+}
+
+#endif /* TESTSUPPORT_H_ */
@@ -0,0 +1,233 @@
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "Arena.h"
+#include "WordBucket.h"
+#include "TestSupport.h"
+
+static_assert(std::is_nothrow_move_constructible<WordBucket>::value, "buckets move without throwing");
+static_assert(std::is_nothrow_move_assignable<WordBucket>::value, "buckets move without throwing");
+
+/** The expected contents of a bucket: each word and its line numbers */
+using Expected = std::map<std::string, std::vector<int>>;
+
+/**
+ * Adds words starting with 'b' on increasing lines to a bucket and to its expected contents.
+ * @param bucket The bucket.
+ * @param expected The expected contents.
+ * @param count The number of words to add.
+ * @param firstLine The line of the first word.
+ * @param seed The seed of the linear congruential generator picking the words.
+ */
+static void addWords(WordBucket& bucket, Expected& expected, int count, int firstLine, uint32_t seed) {
+    for (int i = 0; i < count; i++) {
+        std::string word = "b";
+        seed = seed * 1664525u + 1013904223u;
+        for (uint32_t bits = seed >> 8, letters = 1 + bits % 4; letters > 0; letters--, bits /= 7) {
+            word += static_cast<char>('a' + bits % 7);
+        }
+        int line = firstLine + i / 3;
+        bucket.addSorted(word, line);
+        expected[word].push_back(line);
+    }
+}
+
+/**
+ * Checks that a bucket holds exactly the expected words, in order, and finds each of them.
+ * @param bucket The bucket.
+ * @param expected The expected contents.
+ */
+static void checkContents(const WordBucket& bucket, const Expected& expected) {
+    CHECK(bucket.listSize() == expected.size());
+    auto position = expected.begin();
+    for (const Word& word : bucket) {
+        if (position == expected.end()) {
+            CHECK(false);
+            return;
+        }
+        CHECK(word.view() == position->first);
+        const NumList& lines = word.getNumberList();
+        CHECK(std::vector<int>(lines.begin(), lines.end()) == position->second);
+        ++position;
+    }
+    CHECK(position == expected.end());
+
+    size_t inPartitions = 0;
+    for (size_t i = 0; i < bucket.partitionCount(); i++) {
+        inPartitions += bucket.partition(i).listSize();
+    }
+    CHECK(inPartitions == expected.size());
+
+    for (const auto& entry : expected) {
+        const Word* found = bucket.find(entry.first);
+        CHECK(found != nullptr && found->getFrequency() == static_cast<int>(entry.second.size()));
+    }
+    CHECK(bucket.find("bz") == nullptr);
+    for (const char* key : { "b", "bc", "bdd", "bg", "bz" }) {
+        auto position = expected.lower_bound(key);
+        auto found = bucket.seek(key);
+        CHECK((found == bucket.end()) == (position == expected.end()));
+        if (found != bucket.end() && position != expected.end()) {
+            CHECK(found->view() == position->first);
+        }
+    }
+}
+
+/**
+ * Checks that partitions split as they fill and that repartitioning keeps the words.
+ */
+static void checkSplit() {
+    WordBucket bucket;
+    bucket.setPartitioning(2, 16);
+    Expected expected;
+    addWords(bucket, expected, 3000, 1, 1);
+    CHECK(bucket.partitionCount() > 1);
+    checkContents(bucket, expected);
+
+    size_t twoBytes = bucket.partitionCount();
+    bucket.setPartitioning(3, 8);
+    CHECK(bucket.partitionCount() > twoBytes);
+    checkContents(bucket, expected);
+
+    bucket.setPartitioning(1, 0);
+    CHECK(bucket.partitionCount() == 1);
+    checkContents(bucket, expected);
+
+    // Words added after repartitioning land in the right place
+    bucket.setPartitioning(2, 4);
+    addWords(bucket, expected, 500, 2000, 2);
+    checkContents(bucket, expected);
+}
+
+/**
+ * Checks partitioning words that hold zero bytes, as words read from binary input can. Their prefix keys have
+ * zero bytes before non-zero ones, which must still cut the partitions in sorted order.
+ */
+static void checkZeroBytes() {
+    WordBucket bucket;
+    bucket.setPartitioning(3, 8);
+    Expected expected;
+    for (int i = 0; i < 17; i++) {
+        std::string zero = std::string("a", 1) + '\0' + static_cast<char>('a' + i % 5) + std::to_string(i);
+        for (const std::string& word : { zero, "a" + std::to_string(i), std::string("a") }) {
+            bucket.addSorted(word, i + 1);
+            expected[word].push_back(i + 1);
+        }
+    }
+    CHECK(bucket.partitionCount() > 1);
+    checkContents(bucket, expected);
+
+    bucket.setPartitioning(2, 4);
+    checkContents(bucket, expected);
+
+    // Merging cuts this bucket's words at the other bucket's partition keys
+    WordBucket target;
+    target.setPartitioning(3, 8);
+    Expected merged;
+    for (int i = 0; i < 17; i += 2) {
+        std::string word = std::string("a", 1) + '\0' + static_cast<char>('a' + i % 3);
+        target.addSorted(word, 100);
+        merged[word].push_back(100);
+    }
+    for (const auto& entry : expected) {
+        for (int line : entry.second) {
+            merged[entry.first].push_back(line + 100);
+        }
+    }
+    bucket.setPartitioning(3, 8);
+    target.merge(static_cast<const WordBucket&>(bucket), 100);
+    checkContents(target, merged);
+}
+
+/**
+ * Checks merging a bucket partitioned differently into another, by copying and by moving.
+ */
+static void checkMerge() {
+    const int lineOffset = 1000;
+    Expected firstWords;
+    Expected secondWords;
+    WordBucket first;
+    WordBucket second;
+    first.setPartitioning(2, 32);
+    second.setPartitioning(3, 8);
+    addWords(first, firstWords, 800, 1, 3);
+    addWords(second, secondWords, 800, 1, 4);
+    Expected merged = firstWords;
+    for (const auto& entry : secondWords) {
+        for (int line : entry.second) {
+            merged[entry.first].push_back(line + lineOffset);
+        }
+    }
+
+    WordBucket copied(first);
+    copied.merge(static_cast<const WordBucket&>(second), lineOffset);
+    checkContents(copied, merged);
+    checkContents(second, secondWords);
+
+    Arena arena;
+    WordBucket inArena;
+    inArena.setArena(&arena);
+    inArena = first;
+    inArena.merge(WordBucket(second), lineOffset);
+    checkContents(inArena, merged);
+
+    first.merge(std::move(second), lineOffset);
+    checkContents(first, merged);
+    CHECK(second.empty());
+}
+
+/**
+ * Checks replacing the contents of a bucket with a list built in order, which is partitioned afresh.
+ */
+static void checkAssign() {
+    WordBucket source;
+    Expected expected;
+    addWords(source, expected, 800, 1, 7);
+
+    WordList sorted;
+    WordList::Appender appender(sorted);
+    for (const auto& entry : expected) {
+        Word word(entry.first, entry.second.front());
+        for (size_t i = 1; i < entry.second.size(); i++) {
+            word.appendNumber(entry.second[i]);
+        }
+        appender.append(std::move(word));
+    }
+    WordBucket assigned;
+    assigned.setPartitioning(2, 16);
+    assigned.assign(std::move(sorted));
+    CHECK(assigned.partitionCount() > 1);
+    checkContents(assigned, expected);
+}
+
+/**
+ * Checks that a moved-from bucket is empty and still usable.
+ */
+static void checkMove() {
+    Arena arena;
+    WordBucket bucket;
+    bucket.setArena(&arena);
+    Expected expected;
+    addWords(bucket, expected, 200, 1, 5);
+
+    WordBucket moved(std::move(bucket));
+    checkContents(moved, expected);
+    CHECK(bucket.empty() && bucket.partitionCount() == 1);
+
+    Expected again;
+    addWords(bucket, again, 50, 1, 6);
+    checkContents(bucket, again);
+    moved = std::move(bucket);
+    checkContents(moved, again);
+    CHECK(bucket.empty());
+}
+
+int main() {
+    checkSplit();
+    checkZeroBytes();
+    checkMerge();
+    checkAssign();
+    checkMove();
+    return testResult();
+}